@@ -0,0 +1,37 @@
+#include "../include/SimpleCppLogger.hpp"
+#include "alloc-counter.hpp"
+#include "bench.hpp"
+
+//renders numeric placeholders and appends numbers into a reused buffer, counting operator new calls
+//exit code 1 if the measured loop allocates
+int main() {
+	scl::formatter::CompiledFormat format{ "[{seq}] {tid} {elapsed} d{hh:mm:ss.ffffff} {ec} {msg}{nl}", scl::formatters_collection{} };
+	scl::msg::LogMsg log_msg{ "numeric fields", scl::msg::EVENT_TYPE::LOG_FATAL, true, -42 };
+	std::string out;
+	out.reserve(4096);
+
+	const size_t iterations = 1000000;
+	double value = 0.1;
+
+	auto render = [&] {
+		out.clear();
+		format.render(out, log_msg);
+		scl::utils::append_number(out, value);
+		scl::utils::append_number(out, static_cast<long long>(log_msg.sequence));
+		scl::utils::append_padded_number(out, 7, 3);
+		value += 0.25;
+		log_msg.timestamp += std::chrono::microseconds(3);
+		scl_bench::keep(out);
+	};
+
+	//the first render fills thread local date cache
+	render();
+
+	std::uint64_t before = scl_bench::allocation_count();
+	double seconds = scl_bench::measure(iterations, render);
+	std::uint64_t allocations = scl_bench::allocation_count() - before;
+
+	std::printf("%zu renders, %.1f ns/render, %llu allocations\n", iterations, seconds * 1e9 / iterations, static_cast<unsigned long long>(allocations));
+
+	return allocations == 0 ? 0 : 1;
+}
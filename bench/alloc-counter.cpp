@@ -0,0 +1,42 @@
+#include "alloc-counter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace scl_bench {
+
+	static std::atomic<std::uint64_t> allocations{ 0 };
+
+	auto allocation_count() -> std::uint64_t {
+		return allocations.load(std::memory_order_relaxed);
+	}
+}
+
+auto operator new(std::size_t size) -> void* {
+	scl_bench::allocations.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+auto operator new[](std::size_t size) -> void* {
+	return operator new(size);
+}
+
+auto operator delete(void* memory) noexcept -> void {
+	std::free(memory);
+}
+
+auto operator delete[](void* memory) noexcept -> void {
+	std::free(memory);
+}
+
+auto operator delete(void* memory, std::size_t) noexcept -> void {
+	std::free(memory);
+}
+
+auto operator delete[](void* memory, std::size_t) noexcept -> void {
+	std::free(memory);
+}
@@ -0,0 +1,12 @@
+#ifndef scl_bench_alloc_counter
+#define scl_bench_alloc_counter
+
+#include <cstdint>
+
+namespace scl_bench {
+
+	//calls of the replaced global operator new since process start
+	auto allocation_count() -> std::uint64_t;
+}
+
+#endif //scl_bench_alloc_counter
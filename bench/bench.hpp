@@ -0,0 +1,31 @@
+#ifndef scl_bench_utils
+#define scl_bench_utils
+
+#include <chrono>
+#include <cstdio>
+
+namespace scl_bench {
+
+	//seconds spent in iterations calls of fn, after one warm up call
+	template<typename FnT>
+	auto measure(size_t iterations, FnT&& fn) -> double {
+		fn();
+
+		auto begin = std::chrono::steady_clock::now();
+
+		for (size_t i = 0; i < iterations; i++)
+			fn();
+
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+
+	inline const void* volatile sink = nullptr;
+
+	//keeps the optimizer from dropping work whose result is unused
+	template<typename T>
+	auto keep(const T& value) -> void {
+		sink = &value;
+	}
+}
+
+#endif //scl_bench_utils
@@ -0,0 +1,97 @@
+#include "../include/SimpleCppLogger.hpp"
+#include "alloc-counter.hpp"
+#include "bench.hpp"
+
+namespace {
+
+	//reads the record without keeping it, any allocation on the logging path is a copy of LogMsg
+	class ReadingFormatter : public scl::interface::ILogFormatter {
+	public:
+		auto format(std::string& log_text, const scl::msg::LogMsg& log_msg) -> void override {
+			log_text.append(log_msg.msg, 0, 8);
+			scl_bench::keep(log_msg.stack_trace);
+		}
+
+		auto get_search_regex() -> std::string override {
+			return "\\{read\\}";
+		}
+	};
+
+	//passes every record to its formatters, buffer is reused between records
+	class FormattingStrategy : public scl::interface::ILogStrategy {
+	private:
+		std::vector<std::shared_ptr<scl::interface::ILogFormatter>> _formatters;
+		std::string _text;
+
+	public:
+		FormattingStrategy(size_t formatters_count) {
+			for (size_t i = 0; i < formatters_count; i++)
+				_formatters.push_back(std::make_shared<ReadingFormatter>());
+
+			_text.reserve(4096);
+		}
+
+		auto log(const scl::msg::LogMsg& log_msg) -> void override {
+			_text.clear();
+
+			for (auto& formatter : _formatters)
+				formatter->format(_text, log_msg);
+
+			scl_bench::keep(_text);
+		}
+
+		auto flush() -> void override {}
+	};
+}
+
+//logs messages with stack trace through 4 strategies with 4 formatters each, counting operator new calls
+//allocations of the message text and stack trace are measured separately and subtracted
+//exit code 1 if the logging path allocates, i.e. the record is copied
+int main() {
+	const size_t strategies_count = 4;
+	const size_t formatters_count = 4;
+	const size_t iterations = 100000;
+
+	scl::logger_manager::LoggerManager manager;
+	manager.create_logger("bench", std::make_shared<FormattingStrategy>(formatters_count), true);
+	auto logger = manager.get_logger("bench");
+
+	for (size_t i = 1; i < strategies_count; i++)
+		logger->add_strategy(std::make_shared<FormattingStrategy>(formatters_count));
+
+	//longer than small string buffer, so every copy of the text allocates
+	const std::string text(200, 'm');
+
+	auto make_record = [&] {
+		scl::msg::LogMsg log_msg{ text, scl::msg::EVENT_TYPE::LOG_WARNING, false, 0, true };
+		log_msg.stack_trace = boost::stacktrace::stacktrace();
+		scl_bench::keep(log_msg);
+	};
+
+	auto log = [&] {
+		logger->log_warning(std::string(text), true);
+	};
+
+	//stack trace capture loads debug info on first call
+	make_record();
+	log();
+
+	std::uint64_t before = scl_bench::allocation_count();
+	double record_seconds = scl_bench::measure(iterations, make_record);
+	std::uint64_t record_allocations = scl_bench::allocation_count() - before;
+
+	before = scl_bench::allocation_count();
+	double log_seconds = scl_bench::measure(iterations, log);
+	std::uint64_t log_allocations = scl_bench::allocation_count() - before;
+
+	//measure makes one extra warm up call
+	double calls = static_cast<double>(iterations + 1);
+	double extra_per_message = (static_cast<double>(log_allocations) - static_cast<double>(record_allocations)) / calls;
+
+	std::printf("%zu strategies x %zu formatters\n", strategies_count, formatters_count);
+	std::printf("record only: %.1f ns, %.2f allocations/message\n", record_seconds * 1e9 / iterations, record_allocations / calls);
+	std::printf("logged:      %.1f ns, %.2f allocations/message\n", log_seconds * 1e9 / iterations, log_allocations / calls);
+	std::printf("allocations added by logging path: %.2f/message\n", extra_per_message);
+
+	return extra_per_message <= 0.0 ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include "../include/SimpleCppLogger.hpp"
+#include "bench.hpp"
+#include <random>
+
+//compares append_escaped (SSE2/AVX2 when built with them) to append_escaped_scalar
+//exit code 1 if both paths produce different output for any input
+int main() {
+	using scl::formatter::ESCAPE_MODE;
+
+	const std::pair<ESCAPE_MODE, const char*> modes[] = {
+		{ ESCAPE_MODE::JSON, "json" },
+		{ ESCAPE_MODE::C, "c" },
+		{ ESCAPE_MODE::STRIP_CONTROL, "strip" },
+	};
+
+	//random lengths cover SIMD blocks, scalar tail and escapes at block edges
+	std::mt19937 random{ 42 };
+	const char alphabet[] = "abcdefghij \"\\\n\t\x01\x1f\x7f\xc3\xa9";
+	std::string text;
+	std::string simd;
+	std::string scalar;
+
+	for (size_t i = 0; i < 20000; i++)
+	{
+		text.resize(random() % 300);
+
+		for (auto& c : text)
+			c = random() % 8 == 0 ? alphabet[random() % (sizeof(alphabet) - 1)] : static_cast<char>('a' + random() % 26);
+
+		for (auto& mode : modes)
+		{
+			simd.clear();
+			scalar.clear();
+			scl::formatter::append_escaped(simd, text, mode.first);
+			scl::formatter::append_escaped_scalar(scalar, text, mode.first);
+
+			if (simd != scalar)
+			{
+				std::printf("mismatch in %s mode for input of %zu bytes\n", mode.second, text.size());
+				return 1;
+			}
+		}
+	}
+
+	//4 KiB message with one quote every 500 bytes
+	std::string message(4096, 'x');
+
+	for (size_t i = 250; i < message.size(); i += 500)
+		message[i] = '"';
+
+	const size_t iterations = 200000;
+	const double gigabytes = static_cast<double>(message.size()) * iterations / 1e9;
+	std::string out;
+	out.reserve(message.size() * 2);
+
+	std::printf("4 KiB message, %zu iterations, GB/s\n", iterations);
+
+	for (auto& mode : modes)
+	{
+		double scalar_seconds = scl_bench::measure(iterations, [&] {
+			out.clear();
+			scl::formatter::append_escaped_scalar(out, message, mode.first);
+			scl_bench::keep(out);
+		});
+
+		double simd_seconds = scl_bench::measure(iterations, [&] {
+			out.clear();
+			scl::formatter::append_escaped(out, message, mode.first);
+			scl_bench::keep(out);
+		});
+
+		std::printf("  %-6s scalar %6.2f  simd %6.2f\n", mode.second, gigabytes / scalar_seconds, gigabytes / simd_seconds);
+	}
+
+	return 0;
+}
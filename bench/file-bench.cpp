@@ -0,0 +1,114 @@
+#include "../include/SimpleCppLogger.hpp"
+#include <filesystem>
+#include <sstream>
+
+namespace {
+
+	auto make_format() -> std::shared_ptr<scl::msg::LogLevelMsgFormat> {
+		scl::msg::MsgFormat format{ "{msg}{nl}", "{msg}{nl}" };
+		return std::make_shared<scl::msg::LogLevelMsgFormat>(format, format, format, format, format);
+	}
+
+	//FileLogStrategy before the double buffer: records go to a stringstream, which is written to an ofstream when it fills up
+	class StreamFileLogStrategy : public scl::interface::ILogStrategy {
+	private:
+		std::ofstream _file_stream;
+		std::stringstream _log_buffer;
+		size_t _buffer_size;
+		size_t _actual_buffer_filling = 0;
+		scl::formatters_collection _formatters;
+		scl::formatter::compiled_formats _compiled_formats;
+		std::string _record;
+
+	public:
+		StreamFileLogStrategy(const std::string& file_path, std::shared_ptr<scl::msg::LogLevelMsgFormat> log_format, size_t buffer_size)
+			: _file_stream(file_path, std::ios::app), _buffer_size(buffer_size) {
+			_compiled_formats = scl::utils::compile_log_level_format(*log_format, _formatters, true, scl::formatter::COLOR_MODE::STRIP);
+		}
+
+		~StreamFileLogStrategy() {
+			flush();
+		}
+
+		auto log(const scl::msg::LogMsg& log_msg) -> void override {
+			_record.clear();
+			_compiled_formats[scl::msg::LogLevelMsgFormat::format_index(log_msg)].render(_record, log_msg);
+
+			_log_buffer << _record;
+			_actual_buffer_filling += _record.size();
+
+			if (_actual_buffer_filling >= _buffer_size) {
+				_actual_buffer_filling = 0;
+				flush();
+			}
+		}
+
+		auto flush() -> void override {
+			_file_stream << _log_buffer.str();
+			_file_stream.flush();
+			_log_buffer.str(std::string());
+		}
+	};
+
+	//logs records through the strategy and destroys it, so the time covers writing everything to the file
+	template<typename MakeStrategyT>
+	auto write_file(const std::string& file_path, const std::vector<scl::msg::LogMsg>& records, MakeStrategyT make_strategy) -> double {
+		std::filesystem::remove(file_path);
+
+		auto begin = std::chrono::steady_clock::now();
+
+		{
+			std::shared_ptr<scl::interface::ILogStrategy> strategy = make_strategy();
+
+			for (auto& record : records)
+				strategy->log(record);
+
+			strategy->flush();
+		}
+
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+}
+
+//writes the same records with the old stringstream + ofstream path and FileLogStrategy at several buffer and record sizes
+//exit code 1 if a strategy leaves a file of unexpected size
+int main() {
+	const size_t total_bytes = 128 * 1024 * 1024;
+	const size_t buffer_sizes[] = { 1024, 64 * 1024, 1024 * 1024 };
+	const size_t record_sizes[] = { 64, 256, 1024 };
+	std::string file_path = (std::filesystem::temp_directory_path() / "scl-bench-file.log").string();
+	auto log_format = make_format();
+	int exit_code = 0;
+
+	std::printf("%8s %8s %14s %14s\n", "buffer", "record", "stream MiB/s", "file MiB/s");
+
+	for (size_t buffer_size : buffer_sizes)
+	{
+		for (size_t record_size : record_sizes)
+		{
+			//text plus newline makes record_size bytes in the file
+			std::vector<scl::msg::LogMsg> records(total_bytes / record_size, scl::msg::LogMsg{ std::string(record_size - 1, 'r'), scl::msg::EVENT_TYPE::LOG_INFO, false, 0 });
+			size_t expected_size = records.size() * record_size;
+
+			double stream_seconds = write_file(file_path, records, [&] {
+				return std::make_shared<StreamFileLogStrategy>(file_path, log_format, buffer_size);
+			});
+			bool is_stream_ok = std::filesystem::file_size(file_path) == expected_size;
+
+			double file_seconds = write_file(file_path, records, [&] {
+				return std::make_shared<scl::strategy::FileLogStrategy>(file_path, log_format, buffer_size);
+			});
+			bool is_file_ok = std::filesystem::file_size(file_path) == expected_size;
+
+			double mib = static_cast<double>(expected_size) / (1024 * 1024);
+			std::printf("%8zu %8zu %14.1f %14.1f%s\n", buffer_size, record_size, mib / stream_seconds, mib / file_seconds, is_stream_ok && is_file_ok ? "" : "  wrong file size");
+
+			if (!is_stream_ok || !is_file_ok)
+				exit_code = 1;
+		}
+	}
+
+	std::filesystem::remove(file_path);
+
+	return exit_code;
+}
@@ -0,0 +1,69 @@
+#include "../include/SimpleCppLogger.hpp"
+#include "../strategy-extensions/MappedFileLogStrategy.hpp"
+#include <filesystem>
+
+namespace {
+
+	auto make_format() -> std::shared_ptr<scl::msg::LogLevelMsgFormat> {
+		scl::msg::MsgFormat format{ "{msg}{nl}", "{msg}{nl}" };
+		return std::make_shared<scl::msg::LogLevelMsgFormat>(format, format, format, format, format);
+	}
+
+	//logs records through the strategy and destroys it, so the time covers writing everything to the file
+	template<typename MakeStrategyT>
+	auto write_file(const std::string& file_path, const std::vector<scl::msg::LogMsg>& records, MakeStrategyT make_strategy) -> double {
+		std::filesystem::remove(file_path);
+
+		auto begin = std::chrono::steady_clock::now();
+
+		{
+			std::shared_ptr<scl::interface::ILogStrategy> strategy = make_strategy();
+
+			for (auto& record : records)
+				strategy->log(record);
+
+			strategy->flush();
+		}
+
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	}
+}
+
+//writes the same records with FileLogStrategy and MappedFileLogStrategy at several record sizes
+//exit code 1 if a strategy leaves a file of unexpected size
+int main() {
+	const size_t total_bytes = 256 * 1024 * 1024;
+	const size_t record_sizes[] = { 64, 256, 1024, 4096 };
+	std::string file_path = (std::filesystem::temp_directory_path() / "scl-bench-mapped.log").string();
+	auto log_format = make_format();
+	int exit_code = 0;
+
+	std::printf("%8s %14s %14s\n", "record", "file MiB/s", "mapped MiB/s");
+
+	for (size_t record_size : record_sizes)
+	{
+		//text plus newline makes record_size bytes in the file
+		std::vector<scl::msg::LogMsg> records(total_bytes / record_size, scl::msg::LogMsg{ std::string(record_size - 1, 'r'), scl::msg::EVENT_TYPE::LOG_INFO, false, 0 });
+		size_t expected_size = records.size() * record_size;
+
+		double file_seconds = write_file(file_path, records, [&] {
+			return std::make_shared<scl::strategy::FileLogStrategy>(file_path, log_format, 64 * 1024);
+		});
+		bool is_file_ok = std::filesystem::file_size(file_path) == expected_size;
+
+		double mapped_seconds = write_file(file_path, records, [&] {
+			return std::make_shared<scl::extensions::MappedFileLogStrategy>(file_path, log_format);
+		});
+		bool is_mapped_ok = std::filesystem::file_size(file_path) == expected_size;
+
+		double mib = static_cast<double>(expected_size) / (1024 * 1024);
+		std::printf("%8zu %14.1f %14.1f%s\n", record_size, mib / file_seconds, mib / mapped_seconds, is_file_ok && is_mapped_ok ? "" : "  wrong file size");
+
+		if (!is_file_ok || !is_mapped_ok)
+			exit_code = 1;
+	}
+
+	std::filesystem::remove(file_path);
+
+	return exit_code;
+}
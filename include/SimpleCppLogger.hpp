@@ -12,47 +12,209 @@ using json = nlohmann::json;
 #include <fstream>
 #include <vector>
 #include <mutex>
+#include <shared_mutex>
 #include <map>
+#include <unordered_map>
 #include <exception>
+#include <stdexcept>
 #include <iostream>
 #include <regex>
+#include <chrono>
+#include <string_view>
+#include <array>
+#include <utility>
+#include <tuple>
+#include <type_traits>
+#include <charconv>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <optional>
+#include <future>
+#include <filesystem>
 
 #undef interface
 
 #define TO_STRING(obj) std::string(#obj)
 #define FMT_REGEX(name, regex_str) static const std::regex name {regex_str};
+//declare named literal type usable as scl::formatter::StaticFormat argument
+#define SCL_DECLARE_FORMAT_LITERAL(name, literal) struct name { static constexpr auto value() -> std::string_view { return literal; } };
+//scl::formatter::StaticFormat object for inline literal
+#define SCL_STATIC_FORMAT(literal) ([] { SCL_DECLARE_FORMAT_LITERAL(literal_type, literal) return scl::formatter::StaticFormat<literal_type>{}; }())
+//scl::msg::MsgTemplate object for inline literal, arguments are substituted in place of {} when message is written
+#define SCL_FMT(literal) ([] { SCL_DECLARE_FORMAT_LITERAL(literal_type, literal) return scl::msg::MsgTemplate<literal_type>{}; }())
+
+//levels for SCL_ACTIVE_LEVEL, same order as scl::msg::EVENT_TYPE
+#define SCL_LEVEL_DEBUG 0
+#define SCL_LEVEL_INFO 1
+#define SCL_LEVEL_WARNING 2
+#define SCL_LEVEL_ERROR 3
+#define SCL_LEVEL_FATAL 4
+#define SCL_LEVEL_OFF 5
+
+//SCL_LOG_* below this level expand to nothing, their arguments are never evaluated
+#ifndef SCL_ACTIVE_LEVEL
+#if defined(_DEBUG) || defined(DEBUG)
+#define SCL_ACTIVE_LEVEL SCL_LEVEL_DEBUG
+#else
+#define SCL_ACTIVE_LEVEL SCL_LEVEL_INFO
+#endif // _DEBUG
+#endif // SCL_ACTIVE_LEVEL
+
+//arguments are evaluated only if the level is enabled at runtime too
+#define SCL_LOG_IF_ENABLED(logger, event_type, method, ...) do { auto&& _scl_logger_ = (logger); if (_scl_logger_->is_enabled(event_type)) _scl_logger_->method(__VA_ARGS__); } while (0)
+
+//log_debug is compiled out without _DEBUG/DEBUG, so its arguments must not be evaluated either
+#if SCL_ACTIVE_LEVEL <= SCL_LEVEL_DEBUG && (defined(_DEBUG) || defined(DEBUG))
+#define SCL_LOG_DEBUG(logger, ...) SCL_LOG_IF_ENABLED(logger, scl::msg::EVENT_TYPE::LOG_DEBUG, log_debug, __VA_ARGS__)
+#else
+#define SCL_LOG_DEBUG(logger, ...) ((void)0)
+#endif
+
+#if SCL_ACTIVE_LEVEL <= SCL_LEVEL_INFO
+#define SCL_LOG_INFO(logger, ...) SCL_LOG_IF_ENABLED(logger, scl::msg::EVENT_TYPE::LOG_INFO, log_info, __VA_ARGS__)
+#else
+#define SCL_LOG_INFO(logger, ...) ((void)0)
+#endif
+
+#if SCL_ACTIVE_LEVEL <= SCL_LEVEL_WARNING
+#define SCL_LOG_WARNING(logger, ...) SCL_LOG_IF_ENABLED(logger, scl::msg::EVENT_TYPE::LOG_WARNING, log_warning, __VA_ARGS__)
+#else
+#define SCL_LOG_WARNING(logger, ...) ((void)0)
+#endif
+
+#if SCL_ACTIVE_LEVEL <= SCL_LEVEL_ERROR
+#define SCL_LOG_ERROR(logger, ...) SCL_LOG_IF_ENABLED(logger, scl::msg::EVENT_TYPE::LOG_ERROR, log_error, __VA_ARGS__)
+#else
+#define SCL_LOG_ERROR(logger, ...) ((void)0)
+#endif
+
+#if SCL_ACTIVE_LEVEL <= SCL_LEVEL_FATAL
+#define SCL_LOG_FATAL(logger, ...) SCL_LOG_IF_ENABLED(logger, scl::msg::EVENT_TYPE::LOG_FATAL, log_fatal, __VA_ARGS__)
+#else
+#define SCL_LOG_FATAL(logger, ...) ((void)0)
+#endif
 
 namespace scl
 {
 	namespace exceptions
 	{
-		class log_file_unawalable_exception : public std::exception {
+		//runtime_error keeps a copy of the message on every standard library, std::exception(const char*) is MSVC only
+		class log_file_unawalable_exception : public std::runtime_error {
 		public:
 			log_file_unawalable_exception(std::string description, std::string file_name) :
-				std::exception((description + ":" + file_name).c_str()) {}
+				std::runtime_error(description + ":" + file_name) {}
 		};
 
-		class logger_context_already_exist_exception : public std::exception {
+		class logger_context_already_exist_exception : public std::runtime_error {
 		public:
-			logger_context_already_exist_exception(std::string error) : std::exception(error.c_str()) {}
+			logger_context_already_exist_exception(std::string error) : std::runtime_error(error) {}
 		};
 
-		class config_file_unavailable : public std::exception {
+		class config_file_unavailable : public std::runtime_error {
 		public:
 			config_file_unavailable(std::string file_path) :
-				std::exception(("Config file [" + file_path + "] unavailable").c_str()) {}
+				std::runtime_error("Config file [" + file_path + "] unavailable") {}
 		};
 
-		class incorrect_config_format : public std::exception {
+		class incorrect_config_format : public std::runtime_error {
 		public:
 			incorrect_config_format(std::string description) :
-				std::exception(description.c_str()) {}
+				std::runtime_error(description) {}
+		};
+
+		class unsupported_option_exception : public std::runtime_error {
+		public:
+			unsupported_option_exception(std::string description) :
+				std::runtime_error(description) {}
 		};
 	}
 
 	namespace utils
 	{
 		auto _get_datetime_prefix()->std::string;
+
+		//numeric writers append to the buffer with std::to_chars, without temporary strings
+		auto append_number(std::string& out, long long value) -> void;
+		auto append_number(std::string& out, unsigned long long value) -> void;
+		//shortest representation that reads back as the same value
+		auto append_number(std::string& out, double value) -> void;
+		//exactly width digits with leading zeros, keeping the lowest ones
+		auto append_padded_number(std::string& out, unsigned long long value, size_t width) -> void;
+
+		//os id of the calling thread
+		auto current_thread_id() -> std::uint64_t;
+		//unique message number, increasing within a thread
+		//threads take numbers from their own reserved range, so the shared counter isn't touched per message
+		auto next_sequence() -> std::uint64_t;
+		//time of the first call, {elapsed} is counted from it
+		auto start_time() -> std::chrono::system_clock::time_point;
+
+		enum class DATE_FIELD : std::uint_fast8_t
+		{
+			LITERAL = 0,
+			YEAR = 1,
+			SHORT_YEAR = 2,
+			MONTH = 3,
+			DAY = 4,
+			HOUR = 5,
+			MINUTE = 6,
+			SECOND = 7,
+			FRACTION = 8,
+		};
+
+		//d{...} pattern parsed once; the text for the current second is cached and only the fraction digits are patched
+		//not thread safe, each thread keeps its own instances
+		class DatePattern {
+		private:
+			struct Segment {
+				DATE_FIELD field;
+				size_t width;
+				std::string literal;
+			};
+
+			struct FractionSlot {
+				size_t offset;
+				size_t width;
+			};
+
+			std::vector<Segment> _segments;
+			time_t _cached_second = -1;
+			std::string _cached_text;
+			std::vector<FractionSlot> _fraction_slots;
+
+			static auto count_repeat(const std::string& pattern, size_t pos, char c) -> size_t;
+			auto add_literal(char c) -> void;
+			auto rebuild(time_t second) -> void;
+
+		public:
+			DatePattern(const std::string& pattern);
+
+			auto render(std::string& out, std::chrono::system_clock::time_point timestamp) -> void;
+		};
+
+		//text of deferred message argument, strings are appended as is
+		template<typename T>
+		auto append_arg(std::string& out, const T& value) -> void {
+			if constexpr (std::is_convertible_v<const T&, std::string_view>)
+				out += std::string_view(value);
+			else if constexpr (std::is_same_v<T, bool>)
+				out += value ? "true" : "false";
+			else if constexpr (std::is_same_v<T, char>)
+				out += value;
+			else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+				append_number(out, static_cast<long long>(value));
+			else if constexpr (std::is_integral_v<T>)
+				append_number(out, static_cast<unsigned long long>(value));
+			else if constexpr (std::is_floating_point_v<T>)
+				append_number(out, static_cast<double>(value));
+			else
+			{
+				std::ostringstream stream;
+				stream << value;
+				out += stream.str();
+			}
+		}
 	}
 
 	namespace msg
@@ -66,6 +228,100 @@ namespace scl
 			LOG_FATAL = 4,
 		};
 
+		//message template with {} in place of arguments, argument count is checked at compile time
+		template<typename LiteralT>
+		class MsgTemplate
+		{
+		private:
+			static constexpr auto count_args(std::string_view text) -> size_t {
+				size_t count = 0;
+
+				for (size_t pos = text.find("{}"); pos != std::string_view::npos; pos = text.find("{}", pos + 2))
+					count++;
+
+				return count;
+			}
+
+		public:
+			static constexpr size_t arg_count = count_args(LiteralT::value());
+
+			static constexpr auto get_template() -> std::string_view {
+				return LiteralT::value();
+			}
+		};
+
+		//arguments captured by value at the call site, message text is built only when it is written
+		class IMsgArgs
+		{
+		public:
+			virtual ~IMsgArgs() = default;
+
+			virtual auto append_to(std::string& out) const -> void = 0;
+		};
+
+		//strings are copied, caller buffers may not outlive the message
+		template<typename T>
+		using stored_arg_t = std::conditional_t<std::is_convertible_v<const std::decay_t<T>&, std::string_view>, std::string, std::decay_t<T>>;
+
+		template<typename LiteralT, typename... ArgsT>
+		class MsgArgs : public IMsgArgs
+		{
+		private:
+			std::tuple<ArgsT...> _args;
+
+			static auto append_until_arg(std::string& out, std::string_view text, size_t& pos) -> void {
+				size_t arg_pos = text.find("{}", pos);
+				out.append(text.data() + pos, arg_pos - pos);
+				pos = arg_pos + 2;
+			}
+
+			template<size_t... I>
+			auto append_args(std::string& out, std::index_sequence<I...>) const -> void {
+				constexpr std::string_view text = LiteralT::value();
+				size_t pos = 0;
+
+				((append_until_arg(out, text, pos), utils::append_arg(out, std::get<I>(_args))), ...);
+				out.append(text.data() + pos, text.size() - pos);
+			}
+
+		public:
+			template<typename... InArgsT>
+			MsgArgs(InArgsT&&... args) : _args(std::forward<InArgsT>(args)...) {}
+
+			auto append_to(std::string& out) const -> void override {
+				append_args(out, std::index_sequence_for<ArgsT...>{});
+			}
+		};
+
+		//callable returning something convertible to std::string or appending the message to the passed buffer
+		template<typename CallableT>
+		constexpr bool is_msg_callable_v = std::is_invocable_r_v<std::string, std::decay_t<CallableT>&> || std::is_invocable_v<std::decay_t<CallableT>&, std::string&>;
+
+		//message built by callable when it is first written, after level checks and on writer thread in async mode
+		template<typename CallableT>
+		class LazyMsgArgs : public IMsgArgs
+		{
+		private:
+			mutable CallableT _make_msg;
+			mutable std::once_flag _once;
+			mutable std::string _text;
+
+		public:
+			LazyMsgArgs(CallableT make_msg) : _make_msg(std::move(make_msg)) {}
+
+			auto append_to(std::string& out) const -> void override {
+				//every strategy renders the message, callable is invoked only for the first one
+				std::call_once(_once, [this] {
+					if constexpr (std::is_invocable_v<CallableT&, std::string&>)
+						_make_msg(_text);
+					else
+						utils::append_arg(_text, _make_msg());
+				});
+
+				out += _text;
+			}
+		};
+
 		struct LogMsg
 		{
 			std::string msg;
@@ -73,18 +329,443 @@ namespace scl
 			bool has_error_code = false;
 			int error_code;
 			bool has_stack_trace = false;
-			boost::stacktrace::stacktrace stack_trace;
+			//empty unless has_stack_trace, default constructor would capture the current stack
+			boost::stacktrace::stacktrace stack_trace{ 0, 0 };
+			std::chrono::system_clock::time_point timestamp = std::chrono::system_clock::now();
+			std::uint64_t thread_id = utils::current_thread_id();
+			std::uint64_t sequence = utils::next_sequence();
+			//set instead of msg for messages logged with MsgTemplate
+			std::shared_ptr<const IMsgArgs> args = nullptr;
 		};
 
+		//"debug", "info", "warning", "error" or "fatal", throws incorrect_config_format for other names
+		auto event_type_from_string(const std::string& name) -> EVENT_TYPE;
+
+		template<typename LiteralT, typename... ArgsT>
+		auto make_deferred_msg(MsgTemplate<LiteralT>, EVENT_TYPE event_type, bool is_need_stack_trace, ArgsT&&... args) -> LogMsg {
+			static_assert(MsgTemplate<LiteralT>::arg_count == sizeof...(ArgsT), "Argument count does not match {} count in message template");
+
+			LogMsg log_msg{ std::string(), event_type, false, 0, is_need_stack_trace };
+			log_msg.args = std::make_shared<const MsgArgs<LiteralT, stored_arg_t<ArgsT>...>>(std::forward<ArgsT>(args)...);
+			return log_msg;
+		}
+
+		template<typename CallableT>
+		auto make_lazy_msg(EVENT_TYPE event_type, bool is_need_stack_trace, CallableT&& make_msg) -> LogMsg {
+			LogMsg log_msg{ std::string(), event_type, false, 0, is_need_stack_trace };
+			log_msg.args = std::make_shared<const LazyMsgArgs<std::decay_t<CallableT>>>(std::forward<CallableT>(make_msg));
+			return log_msg;
+		}
+
+		using static_render_fn = auto(*)(std::string& out, const LogMsg& log_msg) -> void;
+
+		//renderer generated from a static format, valid while the format string still equals format_template
+		struct StaticMsgRenderer
+		{
+			std::string_view format_template;
+			static_render_fn render_plain = nullptr;
+			static_render_fn render_colored = nullptr;
+		};
+	}
+
+	namespace formatter
+	{
+		//how {set-color:X} tags are resolved when a template is compiled
+		enum class COLOR_MODE : std::uint_fast8_t
+		{
+			STRIP = 0,
+			ANSI = 1,
+		};
+
+		static constexpr std::string_view ansi_color_reset = "\x1b[0m";
+
+		//empty view for unknown color
+		constexpr auto ansi_color(std::string_view color) -> std::string_view {
+			constexpr std::pair<std::string_view, std::string_view> colors[] = {
+				{ "Black", "\x1b[30m" },
+				{ "Grey", "\x1b[90m" },
+				{ "LightGrey", "\x1b[37m" },
+				{ "White", "\x1b[97m" },
+				{ "Blue", "\x1b[34m" },
+				{ "Green", "\x1b[32m" },
+				{ "Cyan", "\x1b[36m" },
+				{ "Red", "\x1b[31m" },
+				{ "Purple", "\x1b[35m" },
+				{ "LightBlue", "\x1b[94m" },
+				{ "LightGreen", "\x1b[92m" },
+				{ "LightCyan", "\x1b[96m" },
+				{ "LightRed", "\x1b[91m" },
+				{ "LightPurple", "\x1b[95m" },
+				{ "Orange", "\x1b[33m" },
+				{ "Yellow", "\x1b[93m" },
+			};
+
+			for (auto& known : colors)
+				if (known.first == color)
+					return known.second;
+
+			return std::string_view{};
+		}
+
+		//escaping applied to message by {msg:json}, {msg:c} and {msg:strip}
+		enum class ESCAPE_MODE : std::uint_fast8_t
+		{
+			NONE = 0,
+			//quotes, backslash and control characters as JSON string escapes
+			JSON = 1,
+			//quotes, backslash and control characters as C string escapes
+			C = 2,
+			//control characters removed
+			STRIP_CONTROL = 3,
+		};
+
+		constexpr auto message_escape_mode(std::string_view placeholder) -> ESCAPE_MODE {
+			if (placeholder == "{msg:json}")
+				return ESCAPE_MODE::JSON;
+			if (placeholder == "{msg:c}")
+				return ESCAPE_MODE::C;
+			if (placeholder == "{msg:strip}")
+				return ESCAPE_MODE::STRIP_CONTROL;
+			return ESCAPE_MODE::NONE;
+		}
+
+		//scans 16/32 bytes at a time with SSE2/AVX2 when available, escapes only at found positions
+		auto append_escaped(std::string& out, std::string_view text, ESCAPE_MODE mode) -> void;
+		//reference implementation without SIMD
+		auto append_escaped_scalar(std::string& out, std::string_view text, ESCAPE_MODE mode) -> void;
+
+		//message text, formats deferred arguments if message was logged with MsgTemplate
+		auto append_message(std::string& out, const msg::LogMsg& log_msg, ESCAPE_MODE mode) -> void;
+		auto append_log_level(std::string& out, msg::EVENT_TYPE event_type) -> void;
+		auto append_error_code(std::string& out, const msg::LogMsg& log_msg) -> void;
+		auto append_stack_trace(std::string& out, const msg::LogMsg& log_msg) -> void;
+		//seconds with microseconds since utils::start_time()
+		auto append_elapsed(std::string& out, const msg::LogMsg& log_msg) -> void;
+
+		//fixed ids of built-in placeholders, formatters from registry get ids starting at CUSTOM
+		enum class PLACEHOLDER_ID : std::uint16_t
+		{
+			LITERAL = 0,
+			DATE = 1,
+			MESSAGE = 2,
+			STACK_TRACE = 3,
+			LOG_LEVEL = 4,
+			NEW_LINE = 5,
+			ERROR_CODE = 6,
+			MESSAGE_JSON = 7,
+			MESSAGE_C = 8,
+			MESSAGE_STRIP_CONTROL = 9,
+			THREAD_ID = 10,
+			SEQUENCE = 11,
+			ELAPSED = 12,
+			CUSTOM = 0x100,
+		};
+
+		struct StaticToken
+		{
+			PLACEHOLDER_ID id;
+			size_t offset;
+			size_t length;
+		};
+
+		//constexpr parser for format templates known at compile time
+		class StaticFormatParser
+		{
+		private:
+			static constexpr auto starts_with(std::string_view text, size_t pos, std::string_view prefix) -> bool {
+				return text.substr(pos, prefix.size()) == prefix;
+			}
+
+		public:
+			static constexpr std::string_view color_tag_prefix = "{set-color:";
+
+			//length of {set-color:X} tag starting at pos, zero if there is none
+			static constexpr auto color_tag_at(std::string_view text, size_t pos) -> size_t {
+				if (!starts_with(text, pos, color_tag_prefix))
+					return 0;
+
+				size_t end = text.find('}', pos);
+				return end == std::string_view::npos ? 0 : end - pos + 1;
+			}
+
+			static constexpr auto color_tag_name(std::string_view text, size_t pos, size_t tag_length) -> std::string_view {
+				return text.substr(pos + color_tag_prefix.size(), tag_length - color_tag_prefix.size() - 1);
+			}
+
+			//writes template with color tags resolved to out if not null, returns resulting size
+			static constexpr auto resolve_colors(std::string_view text, COLOR_MODE mode, char* out) -> size_t {
+				size_t size = 0;
+				bool has_colors = false;
+
+				auto write = [&](std::string_view part) {
+					for (size_t i = 0; i < part.size(); i++)
+					{
+						if (out)
+							out[size] = part[i];
+						size++;
+					}
+				};
+
+				for (size_t pos = 0; pos < text.size();)
+				{
+					size_t tag_length = color_tag_at(text, pos);
+
+					if (tag_length == 0)
+					{
+						write(text.substr(pos, 1));
+						pos++;
+						continue;
+					}
+
+					if (mode == COLOR_MODE::ANSI)
+						write(ansi_color(color_tag_name(text, pos, tag_length)));
+
+					has_colors = true;
+					pos += tag_length;
+				}
+
+				if (has_colors && mode == COLOR_MODE::ANSI)
+					write(ansi_color_reset);
+
+				return size;
+			}
+
+			template<size_t N>
+			static constexpr auto resolve_colors(std::string_view text, COLOR_MODE mode) -> std::array<char, N> {
+				std::array<char, N> resolved{};
+				resolve_colors(text, mode, resolved.data());
+				return resolved;
+			}
+
+			//placeholder starting at pos; LITERAL with zero length if there is none
+			static constexpr auto placeholder_at(std::string_view text, size_t pos) -> StaticToken {
+				if (starts_with(text, pos, "d{"))
+				{
+					size_t end = text.find_first_of("{}", pos + 2);
+					if (end != std::string_view::npos && text[end] == '}' && end > pos + 2)
+						return StaticToken{ PLACEHOLDER_ID::DATE, pos, end - pos + 1 };
+				}
+
+				constexpr std::pair<std::string_view, PLACEHOLDER_ID> placeholders[] = {
+					{ "{msg}", PLACEHOLDER_ID::MESSAGE },
+					{ "{msg:json}", PLACEHOLDER_ID::MESSAGE_JSON },
+					{ "{msg:c}", PLACEHOLDER_ID::MESSAGE_C },
+					{ "{msg:strip}", PLACEHOLDER_ID::MESSAGE_STRIP_CONTROL },
+					{ "{stacktrace}", PLACEHOLDER_ID::STACK_TRACE },
+					{ "{st}", PLACEHOLDER_ID::STACK_TRACE },
+					{ "{loglevel}", PLACEHOLDER_ID::LOG_LEVEL },
+					{ "{ll}", PLACEHOLDER_ID::LOG_LEVEL },
+					{ "{newline}", PLACEHOLDER_ID::NEW_LINE },
+					{ "{nl}", PLACEHOLDER_ID::NEW_LINE },
+					{ "{errcode}", PLACEHOLDER_ID::ERROR_CODE },
+					{ "{ec}", PLACEHOLDER_ID::ERROR_CODE },
+					{ "{threadid}", PLACEHOLDER_ID::THREAD_ID },
+					{ "{tid}", PLACEHOLDER_ID::THREAD_ID },
+					{ "{sequence}", PLACEHOLDER_ID::SEQUENCE },
+					{ "{seq}", PLACEHOLDER_ID::SEQUENCE },
+					{ "{elapsed}", PLACEHOLDER_ID::ELAPSED },
+				};
+
+				for (auto& placeholder : placeholders)
+					if (starts_with(text, pos, placeholder.first))
+						return StaticToken{ placeholder.second, pos, placeholder.first.size() };
+
+				return StaticToken{ PLACEHOLDER_ID::LITERAL, pos, 0 };
+			}
+
+			//every '{' must open a known placeholder or a known color tag
+			static constexpr auto is_valid(std::string_view text) -> bool {
+				for (size_t pos = 0; pos < text.size();)
+				{
+					StaticToken token = placeholder_at(text, pos);
+
+					if (token.length > 0)
+					{
+						pos += token.length;
+						continue;
+					}
+
+					size_t tag_length = color_tag_at(text, pos);
+
+					if (tag_length > 0)
+					{
+						if (ansi_color(color_tag_name(text, pos, tag_length)).empty())
+							return false;
+						pos += tag_length;
+						continue;
+					}
+
+					if (text[pos] == '{' || text[pos] == '}')
+						return false;
+
+					pos++;
+				}
+
+				return true;
+			}
+
+			//fills tokens if not null, returns token count
+			static constexpr auto parse(std::string_view text, StaticToken* tokens) -> size_t {
+				size_t count = 0;
+				size_t literal_begin = 0;
+
+				for (size_t pos = 0; pos < text.size();)
+				{
+					StaticToken token = placeholder_at(text, pos);
+
+					if (token.length == 0)
+					{
+						pos++;
+						continue;
+					}
+
+					if (pos > literal_begin)
+					{
+						if (tokens)
+							tokens[count] = StaticToken{ PLACEHOLDER_ID::LITERAL, literal_begin, pos - literal_begin };
+						count++;
+					}
+
+					if (tokens)
+						tokens[count] = token;
+					count++;
+
+					pos += token.length;
+					literal_begin = pos;
+				}
+
+				if (literal_begin < text.size())
+				{
+					if (tokens)
+						tokens[count] = StaticToken{ PLACEHOLDER_ID::LITERAL, literal_begin, text.size() - literal_begin };
+					count++;
+				}
+
+				return count;
+			}
+
+			template<size_t N>
+			static constexpr auto parse(std::string_view text) -> std::array<StaticToken, N> {
+				std::array<StaticToken, N> tokens{};
+				parse(text, tokens.data());
+				return tokens;
+			}
+		};
+
+		//format template validated and parsed at compile time, render is unrolled per token
+		//color tags are resolved at compile time, so each color mode gets its own renderer
+		//LiteralT provides static constexpr value() returning the template, see SCL_STATIC_FORMAT
+		template<typename LiteralT>
+		class StaticFormat
+		{
+		private:
+			static constexpr std::string_view _template = LiteralT::value();
+			static_assert(StaticFormatParser::is_valid(_template), "unknown placeholder or color in static format");
+
+			template<COLOR_MODE Mode>
+			struct Resolved
+			{
+				static constexpr size_t size = StaticFormatParser::resolve_colors(_template, Mode, nullptr);
+				static constexpr std::array<char, size + 1> text = StaticFormatParser::resolve_colors<size + 1>(_template, Mode);
+				static constexpr std::string_view view{ text.data(), size };
+				static constexpr size_t token_count = StaticFormatParser::parse(view, nullptr);
+				static constexpr std::array<StaticToken, token_count> tokens = StaticFormatParser::parse<token_count>(view);
+			};
+
+			template<COLOR_MODE Mode, size_t I>
+			static auto render_token(std::string& out, const msg::LogMsg& log_msg) -> void {
+				using resolved = Resolved<Mode>;
+				constexpr StaticToken token = resolved::tokens[I];
+
+				if constexpr (token.id == PLACEHOLDER_ID::LITERAL)
+					out.append(resolved::view.data() + token.offset, token.length);
+				else if constexpr (token.id == PLACEHOLDER_ID::DATE)
+				{
+					static thread_local utils::DatePattern pattern{ std::string(resolved::view.substr(token.offset + 2, token.length - 3)) };
+					pattern.render(out, log_msg.timestamp);
+				}
+				else if constexpr (token.id == PLACEHOLDER_ID::MESSAGE)
+					append_message(out, log_msg, ESCAPE_MODE::NONE);
+				else if constexpr (token.id == PLACEHOLDER_ID::MESSAGE_JSON)
+					append_message(out, log_msg, ESCAPE_MODE::JSON);
+				else if constexpr (token.id == PLACEHOLDER_ID::MESSAGE_C)
+					append_message(out, log_msg, ESCAPE_MODE::C);
+				else if constexpr (token.id == PLACEHOLDER_ID::MESSAGE_STRIP_CONTROL)
+					append_message(out, log_msg, ESCAPE_MODE::STRIP_CONTROL);
+				else if constexpr (token.id == PLACEHOLDER_ID::STACK_TRACE)
+					append_stack_trace(out, log_msg);
+				else if constexpr (token.id == PLACEHOLDER_ID::LOG_LEVEL)
+					append_log_level(out, log_msg.event_type);
+				else if constexpr (token.id == PLACEHOLDER_ID::NEW_LINE)
+					out += '\n';
+				else if constexpr (token.id == PLACEHOLDER_ID::ERROR_CODE)
+					append_error_code(out, log_msg);
+				else if constexpr (token.id == PLACEHOLDER_ID::THREAD_ID)
+					utils::append_number(out, static_cast<unsigned long long>(log_msg.thread_id));
+				else if constexpr (token.id == PLACEHOLDER_ID::SEQUENCE)
+					utils::append_number(out, static_cast<unsigned long long>(log_msg.sequence));
+				else if constexpr (token.id == PLACEHOLDER_ID::ELAPSED)
+					append_elapsed(out, log_msg);
+			}
+
+			template<COLOR_MODE Mode, size_t... I>
+			static auto render_tokens(std::string& out, const msg::LogMsg& log_msg, std::index_sequence<I...>) -> void {
+				(render_token<Mode, I>(out, log_msg), ...);
+			}
+
+		public:
+			template<COLOR_MODE Mode>
+			static auto render(std::string& out, const msg::LogMsg& log_msg) -> void {
+				render_tokens<Mode>(out, log_msg, std::make_index_sequence<Resolved<Mode>::token_count>{});
+			}
+
+			static constexpr auto get_template() -> std::string_view {
+				return _template;
+			}
+
+			static constexpr auto get_renderer() -> msg::StaticMsgRenderer {
+				return msg::StaticMsgRenderer{ _template, &render<COLOR_MODE::STRIP>, &render<COLOR_MODE::ANSI> };
+			}
+		};
+	}
+
+	namespace msg
+	{
+		//default templates, compiled at build time
+		namespace default_format
+		{
+			SCL_DECLARE_FORMAT_LITERAL(debug_simple, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Grey}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(debug_with_stacktrace, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Grey}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(info_simple, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Green}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(info_with_stacktrace, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Green}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(warning_simple, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Orange}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(warning_with_stacktrace, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Orange}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(error_simple, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(error_with_stacktrace, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(fatal_simple, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Red} -> \"error_code\": {errcode}{nl}")
+			SCL_DECLARE_FORMAT_LITERAL(fatal_with_stacktrace, "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Red} -> \"error_code\": {errcode}{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}")
+		}
+
 		struct MsgFormat {
 			std::string simple;
 			std::string simple_with_stacktrace;
+			//set when constructed from static formats
+			StaticMsgRenderer simple_renderer{};
+			StaticMsgRenderer simple_with_stacktrace_renderer{};
 
 			MsgFormat(json& msg_format_cfg);
 			MsgFormat(
 				std::string simple = "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Green}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}",
 				std::string simple_with_stacktrace = "{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Green}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}"
 			);
+
+			template<typename SimpleLiteralT, typename StackTraceLiteralT>
+			MsgFormat(formatter::StaticFormat<SimpleLiteralT> simple_format, formatter::StaticFormat<StackTraceLiteralT> simple_with_stacktrace_format) :
+				simple(simple_format.get_template()),
+				simple_with_stacktrace(simple_with_stacktrace_format.get_template()),
+				simple_renderer(simple_format.get_renderer()),
+				simple_with_stacktrace_renderer(simple_with_stacktrace_format.get_renderer())
+			{}
 		};
 
 		struct LogLevelMsgFormat {
@@ -96,31 +777,42 @@ namespace scl
 			LogLevelMsgFormat(json& log_level_msg_format_cfg);
 			LogLevelMsgFormat(
 				MsgFormat debug_format = MsgFormat{
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Grey}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}",
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Grey}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}"
+					formatter::StaticFormat<default_format::debug_simple>{},
+					formatter::StaticFormat<default_format::debug_with_stacktrace>{}
 				},
 				MsgFormat info_format = MsgFormat{
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Green}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}",
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Green}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}"
-	
+					formatter::StaticFormat<default_format::info_simple>{},
+					formatter::StaticFormat<default_format::info_with_stacktrace>{}
 				},
 				MsgFormat warning_format = MsgFormat{
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Orange}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}",
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Orange}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}"
+					formatter::StaticFormat<default_format::warning_simple>{},
+					formatter::StaticFormat<default_format::warning_with_stacktrace>{}
 				},
 				MsgFormat error_format = MsgFormat{
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}",
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}"
+					formatter::StaticFormat<default_format::error_simple>{},
+					formatter::StaticFormat<default_format::error_with_stacktrace>{}
 				},
 				MsgFormat fatal_format = MsgFormat{
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Red} -> \"error_code\": {errcode}{nl}",
-					"{set-color:Cyan}d{hh:mm:ss dd:MM:yyyy} {set-color:Red}<{ll}> {nl}{set-color:Yellow} -> \"message\": \"{msg}\"{nl}{set-color:Red} -> \"error_code\": {errcode}{nl}{set-color:Orange} -> \"stack_trace\":{nl}{st}{nl}"
+					formatter::StaticFormat<default_format::fatal_simple>{},
+					formatter::StaticFormat<default_format::fatal_with_stacktrace>{}
 				});
 
-			auto get_format(LogMsg& log_msg)->std::string;
+			//templates in flat order [debug, debug with stacktrace, info, ...]
+			static constexpr size_t format_count = 10;
+
+			static auto format_index(const LogMsg& log_msg) -> size_t;
+
+			auto get_format(const LogMsg& log_msg) const -> const std::string&;
+			auto get_format(size_t index) const -> const std::string&;
+			auto get_renderer(size_t index) const -> const StaticMsgRenderer&;
 		};
 	}
 
+	namespace context
+	{
+		struct LoggerContext;
+	}
+
 	namespace interface
 	{
 		class ILogStrategy
@@ -128,25 +820,300 @@ namespace scl
 		private:
 			ILogStrategy(ILogStrategy&) = delete;
 			ILogStrategy& operator=(const ILogStrategy&) = delete;
+			std::atomic<msg::EVENT_TYPE> _min_level{ msg::EVENT_TYPE::LOG_DEBUG };
+			std::timed_mutex _write_mutex;
+			//contexts the strategy is added to, their effective level depends on _min_level
+			std::mutex _contexts_mutex;
+			std::vector<context::LoggerContext*> _contexts;
 		public:
 			ILogStrategy() {};
 			virtual ~ILogStrategy() {}
-			virtual auto log(msg::LogMsg log_msg) -> void = 0;
+			virtual auto log(const msg::LogMsg& log_msg) -> void = 0;
 			virtual auto flush() -> void = 0;
+
+			//records are passed in order, override to format the batch in one go
+			virtual auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void {
+				for (size_t i = 0; i < count; i++)
+					log(log_msgs[i]);
+			}
+
+			//passes runs of records of enabled levels to log_batch, whole batch at once when every record is enabled
+			auto log_enabled(const msg::LogMsg* log_msgs, size_t count) -> void {
+				size_t run_begin = 0;
+
+				for (size_t i = 0; i < count; i++)
+				{
+					if (is_enabled(log_msgs[i].event_type))
+						continue;
+
+					if (i > run_begin)
+						log_batch(log_msgs + run_begin, i - run_begin);
+
+					run_begin = i + 1;
+				}
+
+				if (count > run_begin)
+					log_batch(log_msgs + run_begin, count - run_begin);
+			}
+
+			//messages below min level are not passed to log, can be changed while logging
+			auto set_min_level(msg::EVENT_TYPE level) -> void;
+
+			auto get_min_level() const -> msg::EVENT_TYPE {
+				return _min_level.load(std::memory_order_relaxed);
+			}
+
+			//called by LoggerContext when the strategy is added to it and when it is destroyed
+			auto attach_context(context::LoggerContext* context) -> void;
+			auto detach_context(context::LoggerContext* context) -> void;
+
+			auto is_enabled(msg::EVENT_TYPE level) const -> bool {
+				return level >= _min_level.load(std::memory_order_relaxed);
+			}
+
+			//held by context while calling log/flush, strategies of one context are written independently
+			//timed, so a fatal message can give up on a strategy busy past the deadline
+			auto get_write_mutex() -> std::timed_mutex& {
+				return _write_mutex;
+			}
+		};
+
+		//transforms every filled buffer of FileLogStrategy before it is written, called on the writer thread only
+		class IFileEncoder
+		{
+		public:
+			virtual ~IFileEncoder() {}
+			//appends encoded buffer to out, the file gets one encoded chunk per buffer
+			virtual auto encode(const std::string& raw, std::string& out) -> void = 0;
+			//called before an existing file is opened for appending, e.g. to cut off a chunk torn by a crash
+			virtual auto prepare_file(const std::string& file_path) -> void {
+				(void)file_path;
+			}
 		};
 	}
 
 	namespace context
 	{
+		//what log_* does when async queue is full
+		enum class OVERFLOW_POLICY : std::uint_fast8_t
+		{
+			BLOCK = 0,
+			DROP_NEWEST = 1,
+			DROP_OLDEST = 2,
+		};
+
+		struct AsyncDropCounters
+		{
+			std::uint64_t dropped_newest = 0;
+			std::uint64_t dropped_oldest = 0;
+		};
+
+		//bounded multi producer queue drained by a single writer thread
+		class AsyncQueue
+		{
+		private:
+			std::vector<std::optional<msg::LogMsg>> _ring;
+			size_t _head = 0;
+			size_t _size = 0;
+			OVERFLOW_POLICY _policy;
+			bool _stopped = false;
+			//accepted and written messages, dropped oldest ones count as written
+			std::uint64_t _pushed = 0;
+			std::uint64_t _written = 0;
+			std::mutex _mutex;
+			std::condition_variable _not_empty;
+			std::condition_variable _not_full;
+			std::condition_variable _on_written;
+			std::atomic<std::uint64_t> _dropped_newest{ 0 };
+			std::atomic<std::uint64_t> _dropped_oldest{ 0 };
+
+			//frees a slot according to policy, false if the message has to be dropped
+			auto _make_room(std::unique_lock<std::mutex>& lock) -> bool;
+
+		public:
+			AsyncQueue(size_t capacity, OVERFLOW_POLICY policy);
+
+			//false if message was dropped, messages pushed after stop count as dropped newest
+			auto push(msg::LogMsg log_msg) -> bool;
+			//copies messages under one lock, writer is woken once, returns count of accepted messages
+			auto push_batch(const msg::LogMsg* log_msgs, size_t count) -> size_t;
+			//waits for messages and moves all of them to out, false once stopped and empty
+			auto pop_all(std::vector<msg::LogMsg>& out) -> bool;
+			auto mark_written(size_t count) -> void;
+			//waits until every message pushed before the call is passed to strategies
+			auto wait_written() -> void;
+			auto stop() -> void;
+
+			auto get_drop_counters() const -> AsyncDropCounters;
+		};
+
+		struct LoggerContext;
+		class FlushTask;
+
+		struct RingRecord
+		{
+			LoggerContext* context;
+			msg::LogMsg log_msg;
+		};
+
+		//single producer single consumer ring of one producing thread
+		class ThreadRing
+		{
+		private:
+			std::vector<std::optional<RingRecord>> _slots;
+			size_t _mask;
+			//producer and consumer positions live on separate cache lines
+			alignas(64) std::atomic<size_t> _tail{ 0 };
+			alignas(64) std::atomic<size_t> _head{ 0 };
+			std::atomic<bool> _closed{ false };
+			std::atomic<bool> _detached{ false };
+
+		public:
+			//capacity is rounded up to a power of two
+			ThreadRing(size_t capacity);
+
+			//producer side
+			auto try_push(RingRecord& record) -> bool;
+			//copies as many records as fit and publishes them at once, returns their count
+			auto try_push_batch(LoggerContext* context, const msg::LogMsg* log_msgs, size_t count) -> size_t;
+			//set when owning thread exits, remaining records are still drained
+			auto close() -> void;
+			//set when backend is destroyed, producer drops its reference on the next lookup
+			auto detach() -> void;
+			auto is_detached() const -> bool;
+
+			//consumer side
+			auto get_head() const -> size_t;
+			auto get_tail() const -> size_t;
+			auto is_closed() const -> bool;
+			auto at(size_t position) -> RingRecord&;
+			//frees records before position
+			auto release(size_t position) -> void;
+		};
+
+		//drains rings of all producing threads in timestamp order and passes records to their contexts
+		class RingBackend
+		{
+		private:
+			std::uint64_t _id;
+			size_t _ring_capacity;
+			OVERFLOW_POLICY _policy;
+			std::vector<std::shared_ptr<ThreadRing>> _rings;
+			std::mutex _mutex;
+			std::condition_variable _wake;
+			std::condition_variable _on_written;
+			bool _stopped = false;
+			std::atomic<std::uint64_t> _dropped{ 0 };
+			std::thread _consumer;
+
+			//consumer state, reused between passes
+			std::vector<std::shared_ptr<ThreadRing>> _drain_rings;
+			std::vector<size_t> _heads;
+			std::vector<size_t> _tails;
+
+			auto thread_ring() -> ThreadRing&;
+			auto drain() -> size_t;
+			auto run() -> void;
+
+		public:
+			//throws unsupported_option_exception for DROP_OLDEST, records in the ring are owned by the consumer
+			RingBackend(size_t ring_capacity, OVERFLOW_POLICY policy);
+			~RingBackend();
+
+			auto push(LoggerContext* context, msg::LogMsg log_msg) -> void;
+			auto push_batch(LoggerContext* context, const msg::LogMsg* log_msgs, size_t count) -> void;
+			//waits until records pushed by all threads before the call are passed to strategies
+			auto wait_written() -> void;
+
+			auto get_dropped() const -> std::uint64_t;
+		};
+
 		struct LoggerContext
 		{
 		public:
 			LoggerContext() {}
-			LoggerContext(std::shared_ptr<interface::ILogStrategy> strategy) : strategy_list(std::vector{ strategy }) {
-			}
-			~LoggerContext() {}
+			LoggerContext(std::shared_ptr<interface::ILogStrategy> strategy);
+			~LoggerContext();
 			std::vector<std::shared_ptr<interface::ILogStrategy>> strategy_list;
-			std::mutex write_mutex{};
+			//protects strategy_list only, shared while writing, each strategy is locked by its own mutex
+			std::shared_mutex strategy_list_mutex{};
+			//set once by enable_async, messages are then passed to strategies by async_writer
+			//published atomically, so async mode can be enabled while other threads are logging
+			std::atomic<AsyncQueue*> async_queue{ nullptr };
+			std::unique_ptr<AsyncQueue> async_queue_storage;
+			std::mutex async_enable_mutex;
+			std::thread async_writer;
+			//set by LoggerManager::enable_thread_rings, takes precedence over async_queue
+			//may be cleared while logging, ring_backend_storage keeps the backend alive as long as the context
+			std::atomic<RingBackend*> ring_backend{ nullptr };
+			std::shared_ptr<RingBackend> ring_backend_storage;
+			//level set for the context itself
+			std::atomic<msg::EVENT_TYPE> min_level{ msg::EVENT_TYPE::LOG_DEBUG };
+			//max of min_level and the lowest strategy level, messages below it are rejected by ILogger before LogMsg is built
+			std::atomic<msg::EVENT_TYPE> effective_min_level{ msg::EVENT_TYPE::LOG_DEBUG };
+			//serializes updates of effective_min_level
+			std::mutex level_mutex;
+			//how long a fatal message waits for strategies to be written and flushed, can be changed while logging
+			std::atomic<std::chrono::milliseconds> fatal_flush_timeout{ std::chrono::milliseconds{ 1000 } };
+			//one flusher thread per context, started by the first start_flush
+			//a request made while a flush is still pending joins it instead of queuing another one
+			std::thread flusher;
+			std::mutex flush_mutex;
+			std::condition_variable flush_wake;
+			std::shared_ptr<FlushTask> pending_flush;
+			bool flusher_stopped = false;
+
+			//passes message to strategies that accept its level, strategy_list_mutex must be held
+			//strategies still busy at deadline are skipped
+			auto write(const msg::LogMsg& log_msg, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) -> void;
+			auto write_batch(const msg::LogMsg* log_msgs, size_t count, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) -> void;
+			auto flush() -> void;
+			//waits for async queue, then flushes strategies added before the call on the flusher thread
+			auto start_flush() -> std::shared_ptr<FlushTask>;
+
+			auto add_strategy(std::shared_ptr<interface::ILogStrategy> strategy) -> void;
+			auto set_min_level(msg::EVENT_TYPE level) -> void;
+			//recomputes effective_min_level, called when context or strategy level changes
+			auto update_effective_min_level() -> void;
+
+			//messages logged before the call are written synchronously, later ones through the queue
+			auto enable_async(size_t queue_capacity, OVERFLOW_POLICY policy) -> void;
+			//no-op for synchronous context
+			auto wait_async_written() -> void;
+			//not thread safe against another attach, LoggerManager calls it under its mutex
+			auto attach_ring_backend(std::shared_ptr<RingBackend> backend) -> void;
+		};
+
+		struct FlushReport
+		{
+			//false if the deadline passed before every strategy was flushed
+			bool completed = true;
+			//strategies whose flush was not finished by the deadline
+			std::vector<std::shared_ptr<interface::ILogStrategy>> unfinished;
+		};
+
+		//flush of one context, run by its flusher thread
+		//the caller may stop waiting at any time, several callers may share one task
+		class FlushTask
+		{
+		private:
+			std::vector<std::shared_ptr<interface::ILogStrategy>> _strategies;
+			std::vector<bool> _flushed;
+			bool _finished = false;
+			std::mutex _mutex;
+			std::condition_variable _on_finished;
+			std::vector<std::promise<FlushReport>> _promises;
+
+			auto mark_flushed(const interface::ILogStrategy& strategy) -> void;
+
+		public:
+			//called until the task is run, strategies are only added, so the last list covers every request
+			auto set_strategies(std::vector<std::shared_ptr<interface::ILogStrategy>> strategies) -> void;
+			auto run(LoggerContext& context) -> void;
+			//future is ready when every strategy is flushed
+			auto get_future() -> std::future<FlushReport>;
+			//returns at deadline at the latest, flush goes on in background
+			auto wait_until(std::chrono::steady_clock::time_point deadline) -> FlushReport;
 		};
 	}
 
@@ -156,14 +1123,26 @@ namespace scl
 		public:
 			ILogFormatter() {};
 			virtual ~ILogFormatter() {};
-			virtual auto format(std::string& log_text, msg::LogMsg log_msg) -> void = 0;
+			virtual auto format(std::string& log_text, const msg::LogMsg& log_msg) -> void = 0;
 			virtual auto get_search_regex() -> std::string = 0;
 		};
 
+		//formatter appending one placeholder into caller owned buffer
+		//format() is implemented through append(), so it can be used everywhere ILogFormatter is expected
+		class ILogAppendFormatter : public ILogFormatter {
+		public:
+			ILogAppendFormatter() {};
+			virtual ~ILogAppendFormatter() {};
+			//placeholder is the text matched by get_search_regex
+			virtual auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void = 0;
+			auto format(std::string& log_text, const msg::LogMsg& log_msg) -> void override;
+		};
+
 		class ILogger
 		{
 		protected:
-			std::shared_ptr<context::LoggerContext> _logger_context;
+			//never reassigned, logger can be shared between threads without refcount traffic on log calls
+			const std::shared_ptr<context::LoggerContext> _logger_context;
 
 		private:
 			ILogger() = delete;
@@ -171,8 +1150,7 @@ namespace scl
 			ILogger& operator=(const ILogger&) = delete;
 
 		public:
-			ILogger(std::shared_ptr<context::LoggerContext> context) {
-				_logger_context = context;
+			ILogger(std::shared_ptr<context::LoggerContext> context) : _logger_context(std::move(context)) {
 			}
 			virtual ~ILogger() {};
 			//log debug to corrent logger
@@ -185,8 +1163,162 @@ namespace scl
 			virtual auto log_error(std::string msg, bool is_need_stack_trace = true) -> void = 0;
 			//log fatal to corrent logger
 			virtual auto log_fatal(std::string msg, int error_code, bool is_need_stack_trace = true) -> void = 0;
+			//log prepared message to corrent logger
+			virtual auto log(msg::LogMsg log_msg) -> void = 0;
+			//log prepared messages, context is locked and strategies are called once per batch
+			//records are copied only when queued for async writing or when a stack trace has to be captured
+			virtual auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void = 0;
 			//flush corrent logger_section
 			virtual auto flush() -> void = 0;
+			//flush corrent logger_section on a background thread
+			virtual auto flush_async() -> std::future<context::FlushReport> = 0;
+			//flush corrent logger_section, waits no longer than deadline
+			virtual auto flush_until(std::chrono::steady_clock::time_point deadline) -> context::FlushReport = 0;
+
+			//message is copied into the record only if level is enabled
+			auto log_debug(std::string_view msg, bool is_need_stack_trace = false) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_DEBUG))
+					log_debug(std::string(msg), is_need_stack_trace);
+			}
+
+			auto log_debug(const char* msg, bool is_need_stack_trace = false) -> void {
+				log_debug(std::string_view(msg), is_need_stack_trace);
+			}
+
+			auto log_info(std::string_view msg, bool is_need_stack_trace = false) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_INFO))
+					log_info(std::string(msg), is_need_stack_trace);
+			}
+
+			auto log_info(const char* msg, bool is_need_stack_trace = false) -> void {
+				log_info(std::string_view(msg), is_need_stack_trace);
+			}
+
+			auto log_warning(std::string_view msg, bool is_need_stack_trace = true) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_WARNING))
+					log_warning(std::string(msg), is_need_stack_trace);
+			}
+
+			auto log_warning(const char* msg, bool is_need_stack_trace = true) -> void {
+				log_warning(std::string_view(msg), is_need_stack_trace);
+			}
+
+			auto log_error(std::string_view msg, bool is_need_stack_trace = true) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_ERROR))
+					log_error(std::string(msg), is_need_stack_trace);
+			}
+
+			auto log_error(const char* msg, bool is_need_stack_trace = true) -> void {
+				log_error(std::string_view(msg), is_need_stack_trace);
+			}
+
+			auto log_fatal(std::string_view msg, int error_code, bool is_need_stack_trace = true) -> void {
+				log_fatal(std::string(msg), error_code, is_need_stack_trace);
+			}
+
+			auto log_fatal(const char* msg, int error_code, bool is_need_stack_trace = true) -> void {
+				log_fatal(std::string_view(msg), error_code, is_need_stack_trace);
+			}
+
+			//single relaxed load, checked before message is built
+			//false also when no strategy of the context accepts the level
+			auto is_enabled(msg::EVENT_TYPE level) const -> bool {
+				return level >= _logger_context->effective_min_level.load(std::memory_order_relaxed);
+			}
+
+			//applies to all loggers of the context, can be changed while logging
+			auto set_min_level(msg::EVENT_TYPE level) -> void {
+				_logger_context->set_min_level(level);
+			}
+
+			//bounds writing and flushing of fatal messages of the context, can be changed while logging
+			auto set_fatal_flush_timeout(std::chrono::milliseconds timeout) -> void {
+				_logger_context->fatal_flush_timeout.store(timeout, std::memory_order_relaxed);
+			}
+
+			//log debug with arguments formatted when message is written
+			template<typename LiteralT, typename... ArgsT>
+			auto log_debug(msg::MsgTemplate<LiteralT> msg_template, ArgsT&&... args) -> void {
+#if defined(_DEBUG) || defined(DEBUG)
+				if (is_enabled(msg::EVENT_TYPE::LOG_DEBUG))
+					log(msg::make_deferred_msg(msg_template, msg::EVENT_TYPE::LOG_DEBUG, false, std::forward<ArgsT>(args)...));
+#endif // _DEBUG
+			}
+
+			//log info with arguments formatted when message is written
+			template<typename LiteralT, typename... ArgsT>
+			auto log_info(msg::MsgTemplate<LiteralT> msg_template, ArgsT&&... args) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_INFO))
+					log(msg::make_deferred_msg(msg_template, msg::EVENT_TYPE::LOG_INFO, false, std::forward<ArgsT>(args)...));
+			}
+
+			//log warning with arguments formatted when message is written
+			template<typename LiteralT, typename... ArgsT>
+			auto log_warning(msg::MsgTemplate<LiteralT> msg_template, ArgsT&&... args) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_WARNING))
+					log(msg::make_deferred_msg(msg_template, msg::EVENT_TYPE::LOG_WARNING, true, std::forward<ArgsT>(args)...));
+			}
+
+			//log error with arguments formatted when message is written
+			template<typename LiteralT, typename... ArgsT>
+			auto log_error(msg::MsgTemplate<LiteralT> msg_template, ArgsT&&... args) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_ERROR))
+					log(msg::make_deferred_msg(msg_template, msg::EVENT_TYPE::LOG_ERROR, true, std::forward<ArgsT>(args)...));
+			}
+
+			//log fatal with arguments formatted when message is written
+			template<typename LiteralT, typename... ArgsT>
+			auto log_fatal(msg::MsgTemplate<LiteralT> msg_template, int error_code, ArgsT&&... args) -> void {
+				if (!is_enabled(msg::EVENT_TYPE::LOG_FATAL))
+					return;
+
+				msg::LogMsg log_msg = msg::make_deferred_msg(msg_template, msg::EVENT_TYPE::LOG_FATAL, true, std::forward<ArgsT>(args)...);
+				log_msg.has_error_code = true;
+				log_msg.error_code = error_code;
+				log(std::move(log_msg));
+			}
+
+			//log debug built by callable, invoked only if message is written
+			template<typename CallableT, typename = std::enable_if_t<msg::is_msg_callable_v<CallableT>>>
+			auto log_debug(CallableT&& make_msg, bool is_need_stack_trace = false) -> void {
+#if defined(_DEBUG) || defined(DEBUG)
+				if (is_enabled(msg::EVENT_TYPE::LOG_DEBUG))
+					log(msg::make_lazy_msg(msg::EVENT_TYPE::LOG_DEBUG, is_need_stack_trace, std::forward<CallableT>(make_msg)));
+#endif // _DEBUG
+			}
+
+			//log info built by callable, invoked only if message is written
+			template<typename CallableT, typename = std::enable_if_t<msg::is_msg_callable_v<CallableT>>>
+			auto log_info(CallableT&& make_msg, bool is_need_stack_trace = false) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_INFO))
+					log(msg::make_lazy_msg(msg::EVENT_TYPE::LOG_INFO, is_need_stack_trace, std::forward<CallableT>(make_msg)));
+			}
+
+			//log warning built by callable, invoked only if message is written
+			template<typename CallableT, typename = std::enable_if_t<msg::is_msg_callable_v<CallableT>>>
+			auto log_warning(CallableT&& make_msg, bool is_need_stack_trace = true) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_WARNING))
+					log(msg::make_lazy_msg(msg::EVENT_TYPE::LOG_WARNING, is_need_stack_trace, std::forward<CallableT>(make_msg)));
+			}
+
+			//log error built by callable, invoked only if message is written
+			template<typename CallableT, typename = std::enable_if_t<msg::is_msg_callable_v<CallableT>>>
+			auto log_error(CallableT&& make_msg, bool is_need_stack_trace = true) -> void {
+				if (is_enabled(msg::EVENT_TYPE::LOG_ERROR))
+					log(msg::make_lazy_msg(msg::EVENT_TYPE::LOG_ERROR, is_need_stack_trace, std::forward<CallableT>(make_msg)));
+			}
+
+			//log fatal built by callable, invoked only if message is written
+			template<typename CallableT, typename = std::enable_if_t<msg::is_msg_callable_v<CallableT>>>
+			auto log_fatal(CallableT&& make_msg, int error_code, bool is_need_stack_trace = true) -> void {
+				if (!is_enabled(msg::EVENT_TYPE::LOG_FATAL))
+					return;
+
+				msg::LogMsg log_msg = msg::make_lazy_msg(msg::EVENT_TYPE::LOG_FATAL, is_need_stack_trace, std::forward<CallableT>(make_msg));
+				log_msg.has_error_code = true;
+				log_msg.error_code = error_code;
+				log(std::move(log_msg));
+			}
 
 			virtual auto add_strategy(std::shared_ptr<ILogStrategy> strategy) -> void = 0;
 		};
@@ -194,30 +1326,178 @@ namespace scl
 
 	using formatter_rf = std::shared_ptr<scl::interface::ILogFormatter>;
 	using formatters_collection = std::vector<formatter_rf>;
+	using append_formatter_rf = std::shared_ptr<scl::interface::ILogAppendFormatter>;
+
+	namespace formatter
+	{
+		struct FormatToken
+		{
+			PLACEHOLDER_ID id;
+			size_t offset;
+			size_t length;
+			//set for custom placeholders only, owned by CompiledFormat
+			interface::ILogAppendFormatter* formatter;
+		};
+
+		//thread safe registry of custom formatters, replaces per-strategy formatter lookup by type name
+		//formatters are held weakly, id of a formatter nobody refers to anymore is given to the next new one
+		class PlaceholderRegistry
+		{
+		private:
+			struct Entry
+			{
+				//index key, nullptr for a free entry
+				const interface::ILogFormatter* key = nullptr;
+				std::weak_ptr<interface::ILogFormatter> registered;
+				//registered formatter itself or its LegacyFormatterAdapter
+				std::weak_ptr<interface::ILogAppendFormatter> formatter;
+			};
+
+			std::mutex _mutex;
+			std::vector<Entry> _entries;
+			std::unordered_map<const interface::ILogFormatter*, size_t> _index;
+			std::vector<size_t> _free;
+			//live entries after the last sweep, the next one runs once the index doubles
+			size_t _swept_size = 0;
+
+			PlaceholderRegistry() {}
+
+			//frees entries of destroyed formatters
+			auto sweep() -> void;
+
+		public:
+			struct Registration
+			{
+				PLACEHOLDER_ID id;
+				//keeps the entry alive, the id stays valid while it is held
+				append_formatter_rf formatter;
+			};
+
+			static auto instance() -> PlaceholderRegistry&;
+
+			//same formatter instance gets the same id while it is alive
+			//the formatter is rendered through Registration::formatter held by CompiledFormat, without a lookup per record
+			auto register_formatter(formatter_rf formatter) -> Registration;
+		};
+
+		//runs ILogFormatter::format on a copy of the placeholder, for formatters without append support
+		class LegacyFormatterAdapter : public interface::ILogAppendFormatter {
+		private:
+			formatter_rf _formatter;
+		public:
+			LegacyFormatterAdapter(formatter_rf formatter) : _formatter(formatter) {}
+			auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void override;
+			auto get_search_regex() -> std::string override;
+		};
+
+		//format template parsed once into literal spans and placeholders, rendered in a single pass
+		//placeholder tokens point into the original template
+		class CompiledFormat
+		{
+		private:
+			std::string _template;
+			//literal text with color tags already resolved, LITERAL tokens point here
+			std::string _literals;
+			std::vector<FormatToken> _tokens;
+			//formatters of custom tokens
+			std::vector<append_formatter_rf> _custom_formatters;
+			msg::static_render_fn _static_render = nullptr;
+
+		public:
+			CompiledFormat(std::string format_template, const scl::formatters_collection& formatters, COLOR_MODE color_mode = COLOR_MODE::STRIP);
+			//use renderer generated from static format, no tokens are interpreted at runtime
+			CompiledFormat(msg::StaticMsgRenderer renderer, COLOR_MODE color_mode = COLOR_MODE::STRIP);
+
+			auto render(std::string& out, const msg::LogMsg& log_msg) const -> void;
+		};
+
+		using compiled_formats = std::vector<CompiledFormat>;
+	}
+
+	namespace utils
+	{
+		//compiles templates of every level in LogLevelMsgFormat flat order, used by strategies outside of this file
+		auto compile_log_level_format(const msg::LogLevelMsgFormat& log_format, const scl::formatters_collection& formatters, bool allow_static, formatter::COLOR_MODE color_mode) -> formatter::compiled_formats;
+	}
 
 	namespace strategy
 	{
+		//rotation of FileLogStrategy file, zero disables a limit
+		struct RotationPolicy
+		{
+			//file is renamed before a write that would make it larger
+			size_t max_file_size = 0;
+			//file is renamed on the first write after it was opened this long ago
+			std::chrono::seconds interval{ 0 };
+			//renamed files above these limits are deleted oldest first by a background thread
+			size_t max_files = 0;
+			size_t max_total_size = 0;
+
+			auto is_enabled() const -> bool {
+				return max_file_size > 0 || interval.count() > 0;
+			}
+
+			//fields: max_size, interval_seconds, max_files, max_total_size
+			static auto from_json(json& cfg) -> RotationPolicy;
+		};
+
+		//records are formatted straight into one of two buffers,
+		//a filled buffer is written to the file descriptor by writer thread while the other one is being filled
+		//buffers smaller than 64 KiB are written in place without writer thread unless rotation or encoder is set,
+		//rotation and encoding run on writer thread, so logging threads never wait for rename, reopen or compression
 		class FileLogStrategy : public interface::ILogStrategy
 		{
 		private:
-			std::stringstream _log_buffer;
 			std::string _file_path;
-			std::ofstream _file_stream;
+			int _fd = -1;
 			const size_t _buffer_size;
-			size_t _actual_buffer_filling = 0;
+			std::string _buffers[2];
+			//buffer being filled, the other one belongs to writer thread while _is_writing is set
+			size_t _active = 0;
 			std::shared_ptr<msg::LogLevelMsgFormat> _log_format;
 			scl::formatters_collection _formatters;
+			formatter::compiled_formats _compiled_formats;
+
+			std::mutex _writer_mutex;
+			std::condition_variable _writer_wake;
+			std::condition_variable _on_written;
+			bool _is_writing = false;
+			bool _stopped = false;
+			std::thread _writer;
+
+			//null when buffers are written as is
+			std::shared_ptr<interface::IFileEncoder> _encoder;
+			std::string _encoded;
+
+			RotationPolicy _rotation;
+			std::uint64_t _file_size = 0;
+			std::chrono::system_clock::time_point _file_opened_at;
+			//deletes expired rotated files, started only when max_files or max_total_size is set
+			std::condition_variable _retention_wake;
+			bool _is_retention_pending = false;
+			std::thread _retention;
+
+			//hands filled active buffer to writer thread, waits for the previous one first
+			auto submit_buffer() -> void;
+			auto wait_written() -> void;
+			auto run_writer() -> void;
+			//rotates the file first if the buffer doesn't fit the policy, reopens the file if it is closed
+			auto write_buffer(std::string& buffer) -> void;
+			//_fd < 0 if the file can't be opened, the next write retries
+			auto reopen() -> void;
+			auto rotate() -> void;
+			auto run_retention() -> void;
+			auto remove_expired_files() -> void;
 
 		public:
-			FileLogStrategy(std::string file_path = "./default.log", std::shared_ptr<msg::LogLevelMsgFormat> log_format = std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}), size_t buffer_size = 1024, scl::formatters_collection addition_formatters = scl::formatters_collection{});
+			FileLogStrategy(std::string file_path = "./default.log", std::shared_ptr<msg::LogLevelMsgFormat> log_format = std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}), size_t buffer_size = 1024, scl::formatters_collection addition_formatters = scl::formatters_collection{}, RotationPolicy rotation = RotationPolicy{}, std::shared_ptr<interface::IFileEncoder> encoder = nullptr);
 			FileLogStrategy(json& cfg, scl::formatters_collection addition_formatters = scl::formatters_collection{});
 
-			~FileLogStrategy() override {
-				_file_stream.flush();
-				_file_stream.close();
-			}
+			~FileLogStrategy() override;
 
-			auto log(msg::LogMsg log_msg) -> void override;
+			auto log(const msg::LogMsg& log_msg) -> void override;
+
+			auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void override;
 
 			auto flush() -> void override;
 		};
@@ -226,10 +1506,13 @@ namespace scl
 		{
 		private:
 			std::stringstream _log_buffer;
+			formatter::COLOR_MODE _color_mode;
 			const size_t _buffer_size;
 			size_t _actual_buffer_filling = 0;
 			std::shared_ptr<msg::LogLevelMsgFormat> _log_format;
 			scl::formatters_collection _formatters;
+			formatter::compiled_formats _compiled_formats;
+			std::string _record;
 
 		public:
 			ConsoleLogStrategy(std::shared_ptr<msg::LogLevelMsgFormat> log_format = std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}), size_t buffer_size = 1024, scl::formatters_collection addition_formatters = scl::formatters_collection{});
@@ -237,7 +1520,9 @@ namespace scl
 
 			~ConsoleLogStrategy() override {}
 
-			auto log(msg::LogMsg log_msg) -> void override;
+			auto log(const msg::LogMsg& log_msg) -> void override;
+
+			auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void override;
 
 			auto flush() -> void override;
 		};
@@ -254,6 +1539,8 @@ namespace scl
 			ILoggerManager() {}
 			virtual ~ILoggerManager() {}
 			virtual auto flush_all() -> void = 0;
+			//flushes all loggers in parallel, waits no longer than deadline
+			virtual auto flush_all_until(std::chrono::steady_clock::time_point deadline) -> context::FlushReport = 0;
 			virtual auto create_logger(std::string log_name, std::shared_ptr<ILogStrategy> strategy, bool throw_if_exist) -> void = 0;
 			//check existanse log;
 			//if need_create_if_not_exist == true create and return false;
@@ -261,44 +1548,50 @@ namespace scl
 			//if need_create_if_not_exist == anything and exist return true
 			virtual auto is_logger_exist(std::string log_name, bool need_create_if_not_exist, std::shared_ptr<interface::ILogStrategy> strategy) -> bool = 0;
 			virtual auto get_logger(std::string log_name)->std::shared_ptr<ILogger> = 0;
+			//log_* of this logger only enqueue messages, strategies run on a background thread
+			virtual auto enable_async(std::string log_name, size_t queue_capacity, context::OVERFLOW_POLICY policy) -> void = 0;
+			virtual auto get_async_drop_counters(std::string log_name) -> context::AsyncDropCounters = 0;
+			//every thread logs into its own ring, one backend thread writes records of all loggers of this manager
+			virtual auto enable_thread_rings(size_t ring_capacity, context::OVERFLOW_POLICY policy) -> void = 0;
+			virtual auto get_thread_rings_dropped() -> std::uint64_t = 0;
 		};
 	}
 
 	namespace formatter
 	{
-		class DateFormatter : public interface::ILogFormatter {
+		class DateFormatter : public interface::ILogAppendFormatter {
 		public:
-			auto format(std::string& log_text, msg::LogMsg log_msg) -> void override;
+			auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void override;
 			auto get_search_regex() -> std::string override;
 		};
 
-		class MessageFormatter : public interface::ILogFormatter {
+		class MessageFormatter : public interface::ILogAppendFormatter {
 		public:
-			auto format(std::string& log_text, msg::LogMsg log_msg) -> void override;
+			auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void override;
 			auto get_search_regex() -> std::string override;
 		};
 
-		class StackTraceFormatter : public interface::ILogFormatter {
+		class StackTraceFormatter : public interface::ILogAppendFormatter {
 		public:
-			auto format(std::string& log_text, msg::LogMsg log_msg) -> void override;
+			auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void override;
 			auto get_search_regex() -> std::string override;
 		};
 
-		class LogLevelFormatter : public interface::ILogFormatter {
+		class LogLevelFormatter : public interface::ILogAppendFormatter {
 		public:
-			auto format(std::string& log_text, msg::LogMsg log_msg) -> void override;
+			auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void override;
 			auto get_search_regex() -> std::string override;
 		};
 
-		class NewLineFormatter : public interface::ILogFormatter {
+		class NewLineFormatter : public interface::ILogAppendFormatter {
 		public:
-			auto format(std::string& log_text, msg::LogMsg log_msg) -> void override;
+			auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void override;
 			auto get_search_regex() -> std::string override;
 		};
 
-		class ErrorCodeFormatter : public interface::ILogFormatter {
+		class ErrorCodeFormatter : public interface::ILogAppendFormatter {
 		public:
-			auto format(std::string& log_text, msg::LogMsg log_msg) -> void override;
+			auto append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void override;
 			auto get_search_regex() -> std::string override;
 		};
 	}
@@ -311,6 +1604,8 @@ namespace scl
 			auto _log(msg::LogMsg log_msg) -> void;
 
 			auto _flush() -> void;
+			//write and flush bounded by fatal_flush_timeout, so a stuck strategy can't hang the fatal path
+			auto _log_fatal(msg::LogMsg log_msg) -> void;
 
 			auto _add_strategy(std::shared_ptr<interface::ILogStrategy> strategy) -> void;
 
@@ -335,8 +1630,22 @@ namespace scl
 			//log fatal to corrent logger
 			auto log_fatal(std::string msg, int error_code, bool is_need_stack_trace) -> void override;
 
+			using interface::ILogger::log_debug;
+			using interface::ILogger::log_info;
+			using interface::ILogger::log_warning;
+			using interface::ILogger::log_error;
+			using interface::ILogger::log_fatal;
+
+			auto log(msg::LogMsg log_msg) -> void override;
+
+			auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void override;
+
 			auto flush() -> void override;
 
+			auto flush_async() -> std::future<context::FlushReport> override;
+
+			auto flush_until(std::chrono::steady_clock::time_point deadline) -> context::FlushReport override;
+
 			auto add_strategy(std::shared_ptr<interface::ILogStrategy> strategy) -> void override;
 		};
 	}
@@ -348,6 +1657,7 @@ namespace scl
 		private:
 			std::map<std::string, std::shared_ptr<context::LoggerContext>> _logger_context_map;
 			std::mutex* _modify_context_collection_mx;
+			std::shared_ptr<context::RingBackend> _ring_backend;
 
 		public:
 			LoggerManager();
@@ -356,11 +1666,21 @@ namespace scl
 
 			auto flush_all() -> void override;
 
+			auto flush_all_until(std::chrono::steady_clock::time_point deadline) -> context::FlushReport override;
+
 			auto create_logger(std::string log_name, std::shared_ptr<interface::ILogStrategy> strategy, bool throw_if_exist) -> void override;
 
 			auto is_logger_exist(std::string log_name, bool need_create_if_not_exist, std::shared_ptr<interface::ILogStrategy> strategy) -> bool override;
 
 			auto get_logger(std::string log_name)->std::shared_ptr<interface::ILogger> override;
+
+			auto enable_async(std::string log_name, size_t queue_capacity, context::OVERFLOW_POLICY policy) -> void override;
+
+			auto get_async_drop_counters(std::string log_name) -> context::AsyncDropCounters override;
+
+			auto enable_thread_rings(size_t ring_capacity, context::OVERFLOW_POLICY policy) -> void override;
+
+			auto get_thread_rings_dropped() -> std::uint64_t override;
 		};
 	}
 }
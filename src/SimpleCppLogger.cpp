@@ -1,79 +1,281 @@
 #include "../include/SimpleCppLogger.hpp"
-#include <typeinfo>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCL_USE_SSE2
+#endif
 
 using string = std::string;
 
 #if defined(WIN32)
 #include "windows.h"
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <sys/syscall.h>
 #endif // WIN32
 
 namespace scl
 {
-	using formatters_map = std::map<std::string, formatter_rf>;
-
 	namespace utils
 	{
-		class FormattersCachedCollection {
-		private:
-			static scl::formatters_map _formatters_cach;
-		public:
-			template<typename T>
-			static auto get_formatter(string name) -> scl::formatter_rf {
-				if (_formatters_cach.count(name) == 0)
-					_formatters_cach[name] = scl::formatter_rf(new T{});
+		auto compile_msg_format(const std::string& format_template, const msg::StaticMsgRenderer& renderer, const scl::formatters_collection& formatters, bool allow_static, formatter::COLOR_MODE color_mode) -> formatter::CompiledFormat {
+			//static renderer knows only built-in placeholders and is stale once the template string was changed
+			if (allow_static && renderer.render_plain && renderer.format_template == format_template)
+				return formatter::CompiledFormat{ renderer, color_mode };
 
-				return _formatters_cach[name];
-			}
-		};
+			return formatter::CompiledFormat{ format_template, formatters, color_mode };
+		}
 
-		scl::formatters_map FormattersCachedCollection::_formatters_cach = scl::formatters_map();
+		//compiled formats are stored in LogLevelMsgFormat flat order
+		auto compile_log_level_format(const msg::LogLevelMsgFormat& log_format, const scl::formatters_collection& formatters, bool allow_static, formatter::COLOR_MODE color_mode) -> formatter::compiled_formats {
+			formatter::compiled_formats compiled;
+			compiled.reserve(msg::LogLevelMsgFormat::format_count);
 
-		class FormattersCollectionBuilder {
-		private:
-			scl::formatters_collection _formatters;
-			std::shared_ptr<msg::LogLevelMsgFormat> _log_msg_format;
+			for (size_t i = 0; i < msg::LogLevelMsgFormat::format_count; i++)
+				compiled.push_back(compile_msg_format(log_format.get_format(i), log_format.get_renderer(i), formatters, allow_static, color_mode));
 
-			auto format_regex_search(msg::MsgFormat& log_msg_format, const string& regex) {
-				if (
-					std::regex_search(log_msg_format.simple, std::regex{ regex }) ||
-					std::regex_search(log_msg_format.simple_with_stacktrace, std::regex{ regex })
-					) return true;
+			return compiled;
+		}
 
+		//stdout is a terminal that understands ANSI escape sequences
+		auto is_ansi_console() -> bool {
+#if defined(WIN32)
+			if (!_isatty(_fileno(stdout)))
 				return false;
-			}
 
-			auto log_level_format_regex_search(std::shared_ptr<msg::LogLevelMsgFormat>& log_msg_format, const string regex) {
-				if (
-					format_regex_search(log_msg_format->debug, regex) ||
-					format_regex_search(log_msg_format->info, regex) ||
-					format_regex_search(log_msg_format->warning, regex) ||
-					format_regex_search(log_msg_format->error, regex) ||
-					format_regex_search(log_msg_format->fatal, regex)
-					) return true;
+			HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+			DWORD mode = 0;
 
+			if (!GetConsoleMode(console, &mode))
 				return false;
+
+			return SetConsoleMode(console, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+#else
+			return isatty(fileno(stdout)) != 0;
+#endif // WIN32
+		}
+
+		//write value as exactly width digits, keeping the lowest ones
+		auto write_fixed_digits(char* dest, uint64_t value, size_t width) -> void {
+			for (size_t i = width; i > 0; i--)
+			{
+				dest[i - 1] = static_cast<char>('0' + value % 10);
+				value /= 10;
+			}
+		}
+
+		auto append_number(std::string& out, long long value) -> void {
+			char digits[24];
+			auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+			out.append(digits, result.ptr);
+		}
+
+		auto append_number(std::string& out, unsigned long long value) -> void {
+			char digits[24];
+			auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+			out.append(digits, result.ptr);
+		}
+
+		auto append_number(std::string& out, double value) -> void {
+			//shortest round trip double fits in 24 chars, e.g. -1.2345678901234567e-308
+			char digits[32];
+			auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+			out.append(digits, result.ptr);
+		}
+
+		auto append_padded_number(std::string& out, unsigned long long value, size_t width) -> void {
+			size_t offset = out.size();
+			out.resize(offset + width);
+			write_fixed_digits(&out[offset], value, width);
+		}
+
+		auto current_thread_id() -> std::uint64_t {
+			static thread_local std::uint64_t thread_id =
+#if defined(WIN32)
+				static_cast<std::uint64_t>(GetCurrentThreadId());
+#else
+				static_cast<std::uint64_t>(syscall(SYS_gettid));
+#endif // WIN32
+			return thread_id;
+		}
+
+		static constexpr std::uint64_t sequence_range = 4096;
+
+		auto next_sequence() -> std::uint64_t {
+			static std::atomic<std::uint64_t> reserved{ 0 };
+			thread_local std::uint64_t next = 0;
+			thread_local std::uint64_t range_end = 0;
+
+			if (next == range_end)
+			{
+				next = reserved.fetch_add(sequence_range, std::memory_order_relaxed);
+				range_end = next + sequence_range;
 			}
 
-		public: 
-			FormattersCollectionBuilder(std::shared_ptr<msg::LogLevelMsgFormat> log_msg_format, scl::formatters_collection addition_formatters = scl::formatters_collection{})
-				: _log_msg_format(log_msg_format), _formatters(addition_formatters)  { }
+			return next++;
+		}
+
+		auto start_time() -> std::chrono::system_clock::time_point {
+			static const std::chrono::system_clock::time_point time = std::chrono::system_clock::now();
+			return time;
+		}
+
+		auto local_time(time_t time) -> tm {
+			tm result{};
+#if defined(WIN32)
+			localtime_s(&result, &time);
+#else
+			localtime_r(&time, &result);
+#endif // WIN32
+			return result;
+		}
+
+		auto DatePattern::count_repeat(const std::string& pattern, size_t pos, char c) -> size_t {
+			size_t count = 0;
+			while (pos + count < pattern.size() && pattern[pos + count] == c)
+				count++;
+			return count;
+		}
+
+		auto DatePattern::add_literal(char c) -> void {
+			if (_segments.empty() || _segments.back().field != DATE_FIELD::LITERAL)
+				_segments.push_back(Segment{ DATE_FIELD::LITERAL, 0, string() });
+			_segments.back().literal += c;
+		}
+
+		auto DatePattern::rebuild(time_t second) -> void {
+			tm ltm = local_time(second);
 
-			template<class T>
-			auto set_avalable() -> FormattersCollectionBuilder& {
-				T formatter{};
-				if (log_level_format_regex_search(_log_msg_format, formatter.get_search_regex()))
-					_formatters.push_back(FormattersCachedCollection::get_formatter<T>(typeid(T).name()));
-				return *this;
+			_cached_second = second;
+			_cached_text.clear();
+			_fraction_slots.clear();
+
+			for (auto& segment : _segments)
+			{
+				uint64_t value = 0;
+
+				switch (segment.field)
+				{
+				case DATE_FIELD::LITERAL:
+					_cached_text += segment.literal;
+					continue;
+				case DATE_FIELD::YEAR: value = ltm.tm_year + 1900; break;
+				case DATE_FIELD::SHORT_YEAR: value = (ltm.tm_year + 1900) % 100; break;
+				case DATE_FIELD::MONTH: value = ltm.tm_mon + 1; break;
+				case DATE_FIELD::DAY: value = ltm.tm_mday; break;
+				case DATE_FIELD::HOUR: value = ltm.tm_hour; break;
+				case DATE_FIELD::MINUTE: value = ltm.tm_min; break;
+				case DATE_FIELD::SECOND: value = ltm.tm_sec; break;
+				case DATE_FIELD::FRACTION:
+					_fraction_slots.push_back(FractionSlot{ _cached_text.size(), segment.width });
+					break;
+				}
+
+				size_t offset = _cached_text.size();
+				_cached_text.resize(offset + segment.width);
+				write_fixed_digits(&_cached_text[offset], value, segment.width);
 			}
+		}
 
-			auto build() -> scl::formatters_collection {
-				return _formatters;
+		DatePattern::DatePattern(const std::string& pattern) {
+			for (size_t pos = 0; pos < pattern.size();)
+			{
+				char c = pattern[pos];
+				size_t repeat = count_repeat(pattern, pos, c);
+
+				if (c == 'y' && repeat >= 4)
+				{
+					_segments.push_back(Segment{ DATE_FIELD::YEAR, 4, string() });
+					pos += 4;
+				}
+				else if (c == 'y' && repeat >= 2)
+				{
+					_segments.push_back(Segment{ DATE_FIELD::SHORT_YEAR, 2, string() });
+					pos += 2;
+				}
+				else if ((c == 'M' || c == 'd' || c == 'h' || c == 'm' || c == 's') && repeat >= 2)
+				{
+					DATE_FIELD field = c == 'M' ? DATE_FIELD::MONTH : c == 'd' ? DATE_FIELD::DAY : c == 'h' ? DATE_FIELD::HOUR : c == 'm' ? DATE_FIELD::MINUTE : DATE_FIELD::SECOND;
+					_segments.push_back(Segment{ field, 2, string() });
+					pos += 2;
+				}
+				else if (c == 'f')
+				{
+					size_t width = std::min<size_t>(repeat, 9);
+					_segments.push_back(Segment{ DATE_FIELD::FRACTION, width, string() });
+					pos += width;
+				}
+				else if (c == 'n' && repeat >= 9)
+				{
+					_segments.push_back(Segment{ DATE_FIELD::FRACTION, 9, string() });
+					pos += 9;
+				}
+				else
+				{
+					add_literal(c);
+					pos++;
+				}
 			}
-		};
+		}
+
+		auto DatePattern::render(std::string& out, std::chrono::system_clock::time_point timestamp) -> void {
+			auto since_epoch = timestamp.time_since_epoch();
+			auto seconds = std::chrono::floor<std::chrono::seconds>(since_epoch);
+			uint64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds).count();
+
+			time_t second = static_cast<time_t>(seconds.count());
+			if (second != _cached_second)
+				rebuild(second);
+
+			size_t offset = out.size();
+			out += _cached_text;
+
+			static constexpr uint64_t divisors[] = { 1000000000, 100000000, 10000000, 1000000, 100000, 10000, 1000, 100, 10, 1 };
+
+			for (auto& slot : _fraction_slots)
+				write_fixed_digits(&out[offset + slot.offset], nanoseconds / divisors[slot.width], slot.width);
+		}
+
+		//date patterns are few per thread, linear lookup is cheaper than hashing
+		auto thread_date_pattern(std::string_view pattern) -> DatePattern& {
+			thread_local std::vector<std::pair<string, DatePattern>> patterns;
+
+			for (auto& cached : patterns)
+				if (cached.first == pattern)
+					return cached.second;
+
+			patterns.emplace_back(string(pattern), DatePattern{ string(pattern) });
+			return patterns.back().second;
+		}
 	}
 
 	namespace msg
 	{
+		auto event_type_from_string(const std::string& name) -> EVENT_TYPE {
+			if (name == "debug")
+				return EVENT_TYPE::LOG_DEBUG;
+			if (name == "info")
+				return EVENT_TYPE::LOG_INFO;
+			if (name == "warning")
+				return EVENT_TYPE::LOG_WARNING;
+			if (name == "error")
+				return EVENT_TYPE::LOG_ERROR;
+			if (name == "fatal")
+				return EVENT_TYPE::LOG_FATAL;
+
+			throw exceptions::incorrect_config_format("Unknown log level [" + name + "]");
+		}
+
 		MsgFormat::MsgFormat(json& msg_format_cfg) : MsgFormat() {
 			if (msg_format_cfg.contains("simple"))
 				simple = msg_format_cfg["simple"].get<string>();
@@ -90,397 +292,1766 @@ namespace scl
 			simple_with_stacktrace(simple_with_stacktrace)
 		{}
 
-		LogLevelMsgFormat::LogLevelMsgFormat(json& log_level_msg_format_cfg) : LogLevelMsgFormat() {
-			if (log_level_msg_format_cfg.contains("base"))
+		LogLevelMsgFormat::LogLevelMsgFormat(json& log_level_msg_format_cfg) : LogLevelMsgFormat() {
+			if (log_level_msg_format_cfg.contains("base"))
+			{
+				MsgFormat format = MsgFormat{log_level_msg_format_cfg["base"]};
+				debug = format;
+				info = format;
+				warning = format;
+				error = format;
+				fatal = format;
+			}
+
+			if (log_level_msg_format_cfg.contains("debug"))
+				debug = MsgFormat{ log_level_msg_format_cfg["debug"] };
+
+			if (log_level_msg_format_cfg.contains("info"))
+				info = MsgFormat{ log_level_msg_format_cfg["info"] };
+
+			if (log_level_msg_format_cfg.contains("warning"))
+				warning = MsgFormat{ log_level_msg_format_cfg["warning"] };
+
+			if (log_level_msg_format_cfg.contains("error"))
+				error = MsgFormat{ log_level_msg_format_cfg["error"] };
+
+			if (log_level_msg_format_cfg.contains("fatal"))
+				fatal = MsgFormat{ log_level_msg_format_cfg["fatal"] };
+		}
+
+		LogLevelMsgFormat::LogLevelMsgFormat(
+			MsgFormat debug_format, 
+			MsgFormat info_format,
+			MsgFormat warning_format,
+			MsgFormat error_format,
+			MsgFormat fatal_format) : 
+			debug(debug_format), info(info_format), warning(warning_format), error(error_format), fatal(fatal_format)
+		{
+		}
+
+		//level and template of every flat index, no branching on message fields
+		static constexpr MsgFormat LogLevelMsgFormat::* level_formats[] = {
+			&LogLevelMsgFormat::debug,
+			&LogLevelMsgFormat::info,
+			&LogLevelMsgFormat::warning,
+			&LogLevelMsgFormat::error,
+			&LogLevelMsgFormat::fatal,
+		};
+		static constexpr std::string MsgFormat::* msg_templates[] = { &MsgFormat::simple, &MsgFormat::simple_with_stacktrace };
+		static constexpr StaticMsgRenderer MsgFormat::* msg_renderers[] = { &MsgFormat::simple_renderer, &MsgFormat::simple_with_stacktrace_renderer };
+
+		auto LogLevelMsgFormat::format_index(const LogMsg& log_msg) -> size_t {
+			return static_cast<size_t>(log_msg.event_type) * 2 + (log_msg.has_stack_trace ? 1 : 0);
+		}
+
+		auto LogLevelMsgFormat::get_format(const LogMsg& log_msg) const -> const std::string& {
+			return get_format(format_index(log_msg));
+		}
+
+		auto LogLevelMsgFormat::get_format(size_t index) const -> const std::string& {
+			return this->*level_formats[index / 2].*msg_templates[index % 2];
+		}
+
+		auto LogLevelMsgFormat::get_renderer(size_t index) const -> const StaticMsgRenderer& {
+			return this->*level_formats[index / 2].*msg_renderers[index % 2];
+		}
+	}
+
+	namespace strategy
+	{
+
+		static auto open_append(const string& file_path) -> int {
+#if defined(WIN32)
+			return _open(file_path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+			return open(file_path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+#endif // WIN32
+		}
+
+		//short writes are continued, on error the rest of the buffer is dropped
+		static auto write_all(int fd, const char* data, size_t size) -> void {
+			while (size > 0)
+			{
+#if defined(WIN32)
+				int written = _write(fd, data, static_cast<unsigned int>(std::min<size_t>(size, INT_MAX)));
+#else
+				ssize_t written = write(fd, data, size);
+
+				if (written < 0 && errno == EINTR)
+					continue;
+#endif // WIN32
+				if (written <= 0)
+					return;
+
+				data += written;
+				size -= static_cast<size_t>(written);
+			}
+		}
+
+		static constexpr size_t async_write_min_buffer = 64 * 1024;
+
+		static auto file_size(int fd) -> std::uint64_t {
+#if defined(WIN32)
+			return static_cast<std::uint64_t>(_lseeki64(fd, 0, SEEK_END));
+#else
+			return static_cast<std::uint64_t>(lseek(fd, 0, SEEK_END));
+#endif // WIN32
+		}
+
+		static auto close_file(int fd) -> void {
+#if defined(WIN32)
+			_close(fd);
+#else
+			close(fd);
+#endif // WIN32
+		}
+
+		auto RotationPolicy::from_json(json& cfg) -> RotationPolicy {
+			RotationPolicy rotation;
+
+			if (cfg.contains("max_size"))
+				rotation.max_file_size = cfg["max_size"].get<size_t>();
+
+			if (cfg.contains("interval_seconds"))
+				rotation.interval = std::chrono::seconds(cfg["interval_seconds"].get<long long>());
+
+			if (cfg.contains("max_files"))
+				rotation.max_files = cfg["max_files"].get<size_t>();
+
+			if (cfg.contains("max_total_size"))
+				rotation.max_total_size = cfg["max_total_size"].get<size_t>();
+
+			return rotation;
+		}
+
+		FileLogStrategy::FileLogStrategy(string file_path, std::shared_ptr<msg::LogLevelMsgFormat> log_format, size_t buffer_size, scl::formatters_collection addition_formatters, RotationPolicy rotation, std::shared_ptr<interface::IFileEncoder> encoder) : _buffer_size(buffer_size), _encoder(encoder), _rotation(rotation) {
+			_file_path = file_path;
+
+			if (_encoder)
+				_encoder->prepare_file(file_path);
+
+			_fd = open_append(file_path);
+			_log_format = log_format;
+
+			_formatters = addition_formatters;
+			_compiled_formats = utils::compile_log_level_format(*log_format, _formatters, addition_formatters.empty(), formatter::COLOR_MODE::STRIP);
+
+			if (_fd < 0)
+				throw exceptions::log_file_unawalable_exception("Can't open required file", _file_path);
+
+			//a batch may overshoot buffer_size, cleared buffers keep their capacity
+			_buffers[0].reserve(_buffer_size * 2);
+			_buffers[1].reserve(_buffer_size * 2);
+
+			_file_size = file_size(_fd);
+			_file_opened_at = std::chrono::system_clock::now();
+
+			//waking the writer costs more than writing a small buffer in place
+			if (_buffer_size >= async_write_min_buffer || _rotation.is_enabled() || _encoder)
+				_writer = std::thread([this]() { run_writer(); });
+
+			//files left over limits by previous runs are removed too
+			if (_rotation.is_enabled() && (_rotation.max_files > 0 || _rotation.max_total_size > 0))
+			{
+				_is_retention_pending = true;
+				_retention = std::thread([this]() { run_retention(); });
+			}
+		}
+
+		FileLogStrategy::FileLogStrategy(json& cfg, scl::formatters_collection addition_formatters)
+			: FileLogStrategy(
+				cfg.contains("file_path") ? cfg["file_path"].get<string>() : "./default.log",
+				cfg.contains("log_format") ? std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{ cfg["log_format"] }) : std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}),
+				cfg.contains("buffer_size") ? cfg["buffer_size"].get<size_t>() : 1024,
+				addition_formatters,
+				cfg.contains("rotation") ? RotationPolicy::from_json(cfg["rotation"]) : RotationPolicy{}
+			)
+		{
+			if (cfg.contains("min_level"))
+				set_min_level(msg::event_type_from_string(cfg["min_level"].get<string>()));
+		}
+
+		FileLogStrategy::~FileLogStrategy() {
+			flush();
+
+			{
+				std::lock_guard<std::mutex> lg(_writer_mutex);
+				_stopped = true;
+			}
+
+			_writer_wake.notify_one();
+			_retention_wake.notify_one();
+
+			if (_writer.joinable())
+				_writer.join();
+
+			if (_retention.joinable())
+				_retention.join();
+
+			if (_fd >= 0)
+				close_file(_fd);
+		}
+
+		auto FileLogStrategy::log(const msg::LogMsg& log_msg) -> void {
+			log_batch(&log_msg, 1);
+		}
+
+		auto FileLogStrategy::log_batch(const msg::LogMsg* log_msgs, size_t count) -> void {
+			std::string& buffer = _buffers[_active];
+
+			for (size_t i = 0; i < count; i++)
+				_compiled_formats[msg::LogLevelMsgFormat::format_index(log_msgs[i])].render(buffer, log_msgs[i]);
+
+			if (buffer.size() >= _buffer_size)
+				submit_buffer();
+		}
+
+		auto FileLogStrategy::submit_buffer() -> void {
+			if (!_writer.joinable())
+			{
+				write_buffer(_buffers[_active]);
+				return;
+			}
+
+			std::unique_lock<std::mutex> lock(_writer_mutex);
+			_on_written.wait(lock, [this]() { return !_is_writing; });
+
+			if (_buffers[_active].empty())
+				return;
+
+			_is_writing = true;
+			_active ^= 1;
+
+			lock.unlock();
+			_writer_wake.notify_one();
+		}
+
+		auto FileLogStrategy::wait_written() -> void {
+			std::unique_lock<std::mutex> lock(_writer_mutex);
+			_on_written.wait(lock, [this]() { return !_is_writing; });
+		}
+
+		auto FileLogStrategy::run_writer() -> void {
+			std::unique_lock<std::mutex> lock(_writer_mutex);
+
+			while (true)
+			{
+				_writer_wake.wait(lock, [this]() { return _is_writing || _stopped; });
+
+				if (!_is_writing)
+					return;
+
+				std::string& buffer = _buffers[_active ^ 1];
+				lock.unlock();
+
+				write_buffer(buffer);
+
+				lock.lock();
+				_is_writing = false;
+				_on_written.notify_all();
+			}
+		}
+
+		auto FileLogStrategy::write_buffer(std::string& buffer) -> void {
+			const std::string* data = &buffer;
+
+			if (_encoder)
+			{
+				_encoded.clear();
+				_encoder->encode(buffer, _encoded);
+				data = &_encoded;
+			}
+
+			if (_rotation.is_enabled() && _fd >= 0 && _file_size > 0)
+			{
+				bool is_full = _rotation.max_file_size > 0 && _file_size + data->size() > _rotation.max_file_size;
+				bool is_expired = _rotation.interval.count() > 0 && std::chrono::system_clock::now() - _file_opened_at >= _rotation.interval;
+
+				if (is_full || is_expired)
+					rotate();
+			}
+
+			if (_fd < 0)
+				reopen();
+
+			//buffer is dropped while the file can't be opened, like on write errors
+			if (_fd >= 0)
+			{
+				write_all(_fd, data->data(), data->size());
+				_file_size += data->size();
+			}
+
+			buffer.clear();
+		}
+
+		auto FileLogStrategy::reopen() -> void {
+			if (_fd >= 0)
+				close_file(_fd);
+
+			_fd = open_append(_file_path);
+			_file_size = _fd >= 0 ? file_size(_fd) : 0;
+			_file_opened_at = std::chrono::system_clock::now();
+		}
+
+		//file is renamed to <file_path>.<yyyyMMdd-hhmmss>[-n], remove_expired_files matches only this suffix
+		auto FileLogStrategy::rotate() -> void {
+			tm ltm = utils::local_time(std::chrono::system_clock::to_time_t(std::chrono::system_clock::now()));
+			char suffix[32];
+			std::strftime(suffix, sizeof(suffix), ".%Y%m%d-%H%M%S", &ltm);
+
+			std::error_code error;
+			string rotated_path = _file_path + suffix;
+
+			for (size_t i = 1; std::filesystem::exists(rotated_path, error); i++)
+				rotated_path = _file_path + suffix + "-" + std::to_string(i);
+
+#if defined(WIN32)
+			//open files can't be renamed on Windows, the file is reopened even if rename fails
+			close_file(_fd);
+			_fd = -1;
+			std::filesystem::rename(_file_path, rotated_path, error);
+			reopen();
+#else
+			std::filesystem::rename(_file_path, rotated_path, error);
+
+			if (!error)
+				reopen();
+#endif // WIN32
+
+			//if rename failed writing goes on to the same file, the next write retries
+			if (error)
+				return;
+
+			if (_retention.joinable())
+			{
+				{
+					std::lock_guard<std::mutex> lg(_writer_mutex);
+					_is_retention_pending = true;
+				}
+
+				_retention_wake.notify_one();
+			}
+		}
+
+		auto FileLogStrategy::run_retention() -> void {
+			std::unique_lock<std::mutex> lock(_writer_mutex);
+
+			while (true)
+			{
+				_retention_wake.wait(lock, [this]() { return _is_retention_pending || _stopped; });
+
+				if (_stopped)
+					return;
+
+				_is_retention_pending = false;
+				lock.unlock();
+
+				remove_expired_files();
+
+				lock.lock();
+			}
+		}
+
+		static auto parse_digits(std::string_view text, std::uint64_t& value) -> bool {
+			if (text.empty() || !std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; }))
+				return false;
+
+			return std::from_chars(text.data(), text.data() + text.size(), value).ec == std::errc();
+		}
+
+		//parses ".yyyyMMdd-hhmmss[-n]" added by rotate(), false for any other suffix
+		static auto parse_rotation_suffix(std::string_view suffix, std::uint64_t& timestamp, std::uint64_t& index) -> bool {
+			if (suffix.size() < 16 || suffix[0] != '.' || suffix[9] != '-')
+				return false;
+
+			std::uint64_t date;
+			std::uint64_t time;
+
+			if (!parse_digits(suffix.substr(1, 8), date) || !parse_digits(suffix.substr(10, 6), time))
+				return false;
+
+			timestamp = date * 1000000 + time;
+			index = 0;
+
+			std::string_view rest = suffix.substr(16);
+
+			return rest.empty() || (rest[0] == '-' && parse_digits(rest.substr(1), index));
+		}
+
+		auto FileLogStrategy::remove_expired_files() -> void {
+			struct RotatedFile
+			{
+				std::filesystem::path path;
+				std::uintmax_t size;
+				std::uint64_t timestamp;
+				std::uint64_t index;
+			};
+
+			std::filesystem::path path(_file_path);
+			std::filesystem::path directory = path.has_parent_path() ? path.parent_path() : std::filesystem::path(".");
+			string prefix = path.filename().string();
+
+			std::vector<RotatedFile> rotated;
+			std::error_code error;
+
+			for (auto& entry : std::filesystem::directory_iterator(directory, error))
+			{
+				string name = entry.path().filename().string();
+				std::uint64_t timestamp;
+				std::uint64_t index;
+
+				if (name.compare(0, prefix.size(), prefix) != 0 || !parse_rotation_suffix(std::string_view(name).substr(prefix.size()), timestamp, index))
+					continue;
+
+				if (entry.is_regular_file(error))
+					rotated.push_back(RotatedFile{ entry.path(), entry.file_size(error), timestamp, index });
+			}
+
+			//newest first, files rotated within one second are ordered by their -n
+			std::sort(rotated.begin(), rotated.end(), [](const RotatedFile& left, const RotatedFile& right) {
+				return std::tie(left.timestamp, left.index) > std::tie(right.timestamp, right.index);
+			});
+
+			std::uintmax_t total_size = 0;
+
+			for (size_t i = 0; i < rotated.size(); i++)
+			{
+				total_size += rotated[i].size;
+
+				bool is_over_count = _rotation.max_files > 0 && i >= _rotation.max_files;
+				bool is_over_size = _rotation.max_total_size > 0 && total_size > _rotation.max_total_size;
+
+				if (is_over_count || is_over_size)
+					std::filesystem::remove(rotated[i].path, error);
+			}
+		}
+
+		auto FileLogStrategy::flush() -> void {
+			submit_buffer();
+			wait_written();
+		}
+
+		ConsoleLogStrategy::ConsoleLogStrategy(std::shared_ptr<msg::LogLevelMsgFormat> log_format, size_t buffer_size, scl::formatters_collection addition_formatters) : _buffer_size(buffer_size) {
+			_log_format = log_format;
+			_color_mode = utils::is_ansi_console() ? formatter::COLOR_MODE::ANSI : formatter::COLOR_MODE::STRIP;
+			
+			_formatters = addition_formatters;
+			_compiled_formats = utils::compile_log_level_format(*log_format, _formatters, addition_formatters.empty(), _color_mode);
+		}
+
+		ConsoleLogStrategy::ConsoleLogStrategy(json& cfg, scl::formatters_collection addition_formatters) 
+			: ConsoleLogStrategy
+			(
+				cfg.contains("log_format") ? std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{ cfg["log_format"] }) : std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}),
+				cfg.contains("buffer_size") ? cfg["buffer_size"].get<size_t>() : 1024,
+				addition_formatters
+			)
+		{
+			if (cfg.contains("min_level"))
+				set_min_level(msg::event_type_from_string(cfg["min_level"].get<string>()));
+		}
+
+		auto ConsoleLogStrategy::log(const msg::LogMsg& log_msg) -> void {
+			log_batch(&log_msg, 1);
+		}
+
+		auto ConsoleLogStrategy::log_batch(const msg::LogMsg* log_msgs, size_t count) -> void {
+			_record.clear();
+
+			for (size_t i = 0; i < count; i++)
+				_compiled_formats[msg::LogLevelMsgFormat::format_index(log_msgs[i])].render(_record, log_msgs[i]);
+
+			_log_buffer << _record;
+
+			_actual_buffer_filling += _record.size();
+
+			if (_actual_buffer_filling >= _buffer_size) {
+				_actual_buffer_filling = 0;
+				flush();
+			}
+		}
+
+		auto ConsoleLogStrategy::flush() -> void {
+			//color tags were resolved when templates were compiled, buffer is written as is
+			std::cout << _log_buffer.str() << std::flush;
+			_log_buffer.str(string());
+		}
+	}
+
+	namespace interface
+	{
+		auto ILogStrategy::set_min_level(msg::EVENT_TYPE level) -> void {
+			_min_level.store(level, std::memory_order_relaxed);
+
+			std::lock_guard<std::mutex> lg(_contexts_mutex);
+
+			for (auto context : _contexts)
+				context->update_effective_min_level();
+		}
+
+		auto ILogStrategy::attach_context(context::LoggerContext* context) -> void {
+			std::lock_guard<std::mutex> lg(_contexts_mutex);
+			_contexts.push_back(context);
+		}
+
+		auto ILogStrategy::detach_context(context::LoggerContext* context) -> void {
+			std::lock_guard<std::mutex> lg(_contexts_mutex);
+
+			//strategy added twice is attached twice, one entry is removed per detach
+			auto found = std::find(_contexts.begin(), _contexts.end(), context);
+
+			if (found != _contexts.end())
+				_contexts.erase(found);
+		}
+
+		auto ILogAppendFormatter::format(std::string& log_text, const msg::LogMsg& log_msg) -> void {
+			std::regex r{ get_search_regex() };
+			std::string result;
+			size_t position = 0;
+
+			for (auto it = std::sregex_iterator{ log_text.cbegin(), log_text.cend(), r }; it != std::sregex_iterator{}; it++)
+			{
+				result.append(log_text, position, it->position() - position);
+				append(result, std::string_view(log_text).substr(it->position(), it->length()), log_msg);
+				position = it->position() + it->length();
+			}
+
+			result.append(log_text, position, string::npos);
+			log_text = std::move(result);
+		}
+	}
+
+	namespace formatter
+	{
+		auto needs_escape(unsigned char c, ESCAPE_MODE mode) -> bool {
+			if (c < 0x20 || c == 0x7F)
+				return true;
+
+			return mode != ESCAPE_MODE::STRIP_CONTROL && (c == '"' || c == '\\');
+		}
+
+		auto append_escaped_char(std::string& out, unsigned char c, ESCAPE_MODE mode) -> void {
+			static constexpr char hex[] = "0123456789abcdef";
+
+			if (mode == ESCAPE_MODE::STRIP_CONTROL)
+				return;
+
+			switch (c)
+			{
+			case '"': out += "\\\""; return;
+			case '\\': out += "\\\\"; return;
+			case '\n': out += "\\n"; return;
+			case '\r': out += "\\r"; return;
+			case '\t': out += "\\t"; return;
+			case '\b': out += "\\b"; return;
+			case '\f': out += "\\f"; return;
+			}
+
+			if (mode == ESCAPE_MODE::JSON)
+			{
+				//DEL is valid inside JSON strings
+				if (c == 0x7F)
+					out += static_cast<char>(c);
+				else
+				{
+					const char escaped[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF] };
+					out.append(escaped, sizeof(escaped));
+				}
+				return;
+			}
+
+			//octal escape can't swallow following digits the way \x does
+			const char escaped[] = { '\\', static_cast<char>('0' + (c >> 6)), static_cast<char>('0' + ((c >> 3) & 7)), static_cast<char>('0' + (c & 7)) };
+			out.append(escaped, sizeof(escaped));
+		}
+
+		auto append_escaped_scalar(std::string& out, std::string_view text, ESCAPE_MODE mode) -> void {
+			size_t run_begin = 0;
+
+			for (size_t i = 0; i < text.size(); i++)
+			{
+				unsigned char c = static_cast<unsigned char>(text[i]);
+
+				if (!needs_escape(c, mode))
+					continue;
+
+				out.append(text.data() + run_begin, i - run_begin);
+				append_escaped_char(out, c, mode);
+				run_begin = i + 1;
+			}
+
+			out.append(text.data() + run_begin, text.size() - run_begin);
+		}
+
+#if defined(_MSC_VER)
+		inline auto count_trailing_zeros(uint32_t mask) -> uint32_t {
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return index;
+		}
+#else
+		inline auto count_trailing_zeros(uint32_t mask) -> uint32_t {
+			return __builtin_ctz(mask);
+		}
+#endif // _MSC_VER
+
+		auto append_escaped(std::string& out, std::string_view text, ESCAPE_MODE mode) -> void {
+			if (mode == ESCAPE_MODE::NONE)
+			{
+				out += text;
+				return;
+			}
+
+			//every escape grows by at most 6 bytes, reserve for the common case of a few
+			out.reserve(out.size() + text.size() + 16);
+
+			const char* data = text.data();
+			size_t size = text.size();
+			size_t run_begin = 0;
+			size_t i = 0;
+			bool quotes = mode != ESCAPE_MODE::STRIP_CONTROL;
+
+#if defined(__AVX2__)
+			const __m256i control_limit = _mm256_set1_epi8(0x1F);
+			const __m256i del = _mm256_set1_epi8(0x7F);
+			const __m256i quote = _mm256_set1_epi8(quotes ? '"' : 0x7F);
+			const __m256i backslash = _mm256_set1_epi8(quotes ? '\\' : 0x7F);
+
+			for (; i + 32 <= size; i += 32)
+			{
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+				__m256i special = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control_limit), control_limit), _mm256_cmpeq_epi8(chunk, del)),
+					_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)));
+				uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(special));
+
+				while (mask)
+				{
+					size_t pos = i + count_trailing_zeros(mask);
+					out.append(data + run_begin, pos - run_begin);
+					append_escaped_char(out, static_cast<unsigned char>(data[pos]), mode);
+					run_begin = pos + 1;
+					mask &= mask - 1;
+				}
+			}
+#elif defined(SCL_USE_SSE2)
+			const __m128i control_limit = _mm_set1_epi8(0x1F);
+			const __m128i del = _mm_set1_epi8(0x7F);
+			const __m128i quote = _mm_set1_epi8(quotes ? '"' : 0x7F);
+			const __m128i backslash = _mm_set1_epi8(quotes ? '\\' : 0x7F);
+
+			for (; i + 16 <= size; i += 16)
+			{
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+				__m128i special = _mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(chunk, control_limit), control_limit), _mm_cmpeq_epi8(chunk, del)),
+					_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)));
+				uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(special));
+
+				while (mask)
+				{
+					size_t pos = i + count_trailing_zeros(mask);
+					out.append(data + run_begin, pos - run_begin);
+					append_escaped_char(out, static_cast<unsigned char>(data[pos]), mode);
+					run_begin = pos + 1;
+					mask &= mask - 1;
+				}
+			}
+#endif // __AVX2__
+
+			out.append(data + run_begin, i - run_begin);
+			append_escaped_scalar(out, text.substr(i), mode);
+		}
+
+		auto append_message(std::string& out, const msg::LogMsg& log_msg, ESCAPE_MODE mode) -> void {
+			if (!log_msg.args)
+			{
+				if (mode == ESCAPE_MODE::NONE)
+					out += log_msg.msg;
+				else
+					append_escaped(out, log_msg.msg, mode);
+
+				return;
+			}
+
+			if (mode == ESCAPE_MODE::NONE)
+			{
+				log_msg.args->append_to(out);
+				return;
+			}
+
+			static thread_local std::string text;
+			text.clear();
+			log_msg.args->append_to(text);
+			append_escaped(out, text, mode);
+		}
+
+		auto append_log_level(std::string& out, msg::EVENT_TYPE event_type) -> void {
+			switch (event_type)
+			{
+			case msg::EVENT_TYPE::LOG_DEBUG:
+				out += "EVENT_TYPE::LOG_DEBUG";
+				break;
+			case msg::EVENT_TYPE::LOG_INFO:
+				out += "EVENT_TYPE::LOG_INFO";
+				break;
+			case msg::EVENT_TYPE::LOG_WARNING:
+				out += "EVENT_TYPE::LOG_WARNING";
+				break;
+			case msg::EVENT_TYPE::LOG_ERROR:
+				out += "EVENT_TYPE::LOG_ERROR";
+				break;
+			case msg::EVENT_TYPE::LOG_FATAL:
+				out += "EVENT_TYPE::LOG_FATAL";
+				break;
+			}
+		}
+
+		auto append_error_code(std::string& out, const msg::LogMsg& log_msg) -> void {
+			if (!log_msg.has_error_code)
+				return;
+
+			utils::append_number(out, static_cast<long long>(log_msg.error_code));
+		}
+
+		auto append_stack_trace(std::string& out, const msg::LogMsg& log_msg) -> void {
+			if (log_msg.has_stack_trace)
+				out += boost::stacktrace::to_string(log_msg.stack_trace);
+		}
+
+		auto append_elapsed(std::string& out, const msg::LogMsg& log_msg) -> void {
+			auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(log_msg.timestamp - utils::start_time()).count();
+
+			//messages created before the first call
+			if (elapsed < 0)
+				elapsed = 0;
+
+			utils::append_number(out, static_cast<unsigned long long>(elapsed / 1000000));
+			out += '.';
+			utils::append_padded_number(out, static_cast<unsigned long long>(elapsed % 1000000), 6);
+		}
+
+		auto LegacyFormatterAdapter::append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void {
+			thread_local std::string text;
+
+			text.assign(placeholder);
+			_formatter->format(text, log_msg);
+			out += text;
+		}
+
+		auto LegacyFormatterAdapter::get_search_regex() -> std::string {
+			return _formatter->get_search_regex();
+		}
+
+		auto PlaceholderRegistry::instance() -> PlaceholderRegistry& {
+			static PlaceholderRegistry registry;
+			return registry;
+		}
+
+		auto PlaceholderRegistry::sweep() -> void {
+			for (size_t i = 0; i < _entries.size(); i++)
+			{
+				Entry& entry = _entries[i];
+
+				if (entry.key == nullptr || !entry.registered.expired())
+					continue;
+
+				_index.erase(entry.key);
+				entry = Entry{};
+				_free.push_back(i);
+			}
+
+			_swept_size = _index.size();
+		}
+
+		auto PlaceholderRegistry::register_formatter(formatter_rf formatter) -> Registration {
+			std::lock_guard<std::mutex> lg(_mutex);
+
+			size_t index;
+			auto found = _index.find(formatter.get());
+
+			if (found != _index.end() && _entries[found->second].registered.lock() == formatter)
+			{
+				index = found->second;
+
+				if (append_formatter_rf append_formatter = _entries[index].formatter.lock())
+					return Registration{ static_cast<PLACEHOLDER_ID>(static_cast<size_t>(PLACEHOLDER_ID::CUSTOM) + index), append_formatter };
+			}
+			else if (found != _index.end())
+			{
+				//previous formatter at this address is destroyed, its entry is reused
+				index = found->second;
+			}
+			else
+			{
+				if (_index.size() >= _swept_size * 2 + 16)
+					sweep();
+
+				if (_free.empty())
+				{
+					index = _entries.size();
+					_entries.emplace_back();
+				}
+				else
+				{
+					index = _free.back();
+					_free.pop_back();
+				}
+
+				_index.emplace(formatter.get(), index);
+			}
+
+			append_formatter_rf append_formatter = std::dynamic_pointer_cast<interface::ILogAppendFormatter>(formatter);
+
+			if (!append_formatter)
+				append_formatter = std::make_shared<LegacyFormatterAdapter>(formatter);
+
+			_entries[index] = Entry{ formatter.get(), formatter, append_formatter };
+
+			return Registration{ static_cast<PLACEHOLDER_ID>(static_cast<size_t>(PLACEHOLDER_ID::CUSTOM) + index), append_formatter };
+		}
+
+		CompiledFormat::CompiledFormat(std::string format_template, const scl::formatters_collection& formatters, COLOR_MODE color_mode) : _template(format_template) {
+			struct CustomMatch {
+				size_t offset;
+				size_t length;
+				size_t priority;
+				PLACEHOLDER_ID id;
+				interface::ILogAppendFormatter* formatter;
+			};
+
+			std::vector<CustomMatch> custom_matches;
+			PlaceholderRegistry& registry = PlaceholderRegistry::instance();
+
+			//only custom formatters need regex, built-in placeholders are recognized by the parser
+			for (size_t i = 0; i < formatters.size(); i++)
+			{
+				PlaceholderRegistry::Registration registration = registry.register_formatter(formatters[i]);
+				std::regex r{ registration.formatter->get_search_regex() };
+
+				for (auto it = std::sregex_iterator{ _template.cbegin(), _template.cend(), r }; it != std::sregex_iterator{}; it++)
+					if (it->length() > 0)
+						custom_matches.push_back(CustomMatch{ static_cast<size_t>(it->position()), static_cast<size_t>(it->length()), i, registration.id, registration.formatter.get() });
+
+				_custom_formatters.push_back(registration.formatter);
+			}
+
+			//formatters earlier in collection win if placeholders overlap
+			std::sort(custom_matches.begin(), custom_matches.end(), [](const CustomMatch& a, const CustomMatch& b) {
+				return a.offset != b.offset ? a.offset < b.offset : a.priority < b.priority;
+			});
+
+			auto add_literal = [this](std::string_view text) {
+				if (text.empty())
+					return;
+
+				if (!_tokens.empty() && _tokens.back().id == PLACEHOLDER_ID::LITERAL)
+					_tokens.back().length += text.size();
+				else
+					_tokens.push_back(FormatToken{ PLACEHOLDER_ID::LITERAL, _literals.size(), text.size(), nullptr });
+
+				_literals += text;
+			};
+
+			std::string_view text = _template;
+			bool has_colors = false;
+			size_t literal_begin = 0;
+			size_t position = 0;
+			auto next_custom = custom_matches.begin();
+
+			while (position < text.size())
+			{
+				while (next_custom != custom_matches.end() && next_custom->offset < position)
+					next_custom++;
+
+				size_t tag_length = StaticFormatParser::color_tag_at(text, position);
+				StaticToken builtin = StaticFormatParser::placeholder_at(text, position);
+				bool is_custom = next_custom != custom_matches.end() && next_custom->offset == position;
+
+				if (tag_length == 0 && !is_custom && builtin.length == 0)
+				{
+					position++;
+					continue;
+				}
+
+				add_literal(text.substr(literal_begin, position - literal_begin));
+
+				if (tag_length > 0)
+				{
+					if (color_mode == COLOR_MODE::ANSI)
+						add_literal(ansi_color(StaticFormatParser::color_tag_name(text, position, tag_length)));
+
+					has_colors = true;
+					position += tag_length;
+				}
+				else if (is_custom)
+				{
+					_tokens.push_back(FormatToken{ next_custom->id, position, next_custom->length, next_custom->formatter });
+					position += next_custom->length;
+				}
+				else
+				{
+					_tokens.push_back(FormatToken{ builtin.id, position, builtin.length, nullptr });
+					position += builtin.length;
+				}
+
+				literal_begin = position;
+			}
+
+			add_literal(text.substr(literal_begin));
+
+			if (has_colors && color_mode == COLOR_MODE::ANSI)
+				add_literal(ansi_color_reset);
+		}
+
+		CompiledFormat::CompiledFormat(msg::StaticMsgRenderer renderer, COLOR_MODE color_mode) :
+			_template(renderer.format_template),
+			_static_render(color_mode == COLOR_MODE::ANSI ? renderer.render_colored : renderer.render_plain)
+		{}
+
+		auto CompiledFormat::render(std::string& out, const msg::LogMsg& log_msg) const -> void {
+			if (_static_render)
+			{
+				_static_render(out, log_msg);
+				return;
+			}
+
+			for (auto& token : _tokens)
+			{
+				switch (token.id)
+				{
+				case PLACEHOLDER_ID::LITERAL:
+					out.append(_literals, token.offset, token.length);
+					break;
+				case PLACEHOLDER_ID::DATE:
+					//placeholder is d{pattern}
+					utils::thread_date_pattern(std::string_view(_template).substr(token.offset + 2, token.length - 3)).render(out, log_msg.timestamp);
+					break;
+				case PLACEHOLDER_ID::MESSAGE:
+					append_message(out, log_msg, ESCAPE_MODE::NONE);
+					break;
+				case PLACEHOLDER_ID::MESSAGE_JSON:
+					append_message(out, log_msg, ESCAPE_MODE::JSON);
+					break;
+				case PLACEHOLDER_ID::MESSAGE_C:
+					append_message(out, log_msg, ESCAPE_MODE::C);
+					break;
+				case PLACEHOLDER_ID::MESSAGE_STRIP_CONTROL:
+					append_message(out, log_msg, ESCAPE_MODE::STRIP_CONTROL);
+					break;
+				case PLACEHOLDER_ID::STACK_TRACE:
+					append_stack_trace(out, log_msg);
+					break;
+				case PLACEHOLDER_ID::LOG_LEVEL:
+					append_log_level(out, log_msg.event_type);
+					break;
+				case PLACEHOLDER_ID::NEW_LINE:
+					out += '\n';
+					break;
+				case PLACEHOLDER_ID::ERROR_CODE:
+					append_error_code(out, log_msg);
+					break;
+				case PLACEHOLDER_ID::THREAD_ID:
+					utils::append_number(out, static_cast<unsigned long long>(log_msg.thread_id));
+					break;
+				case PLACEHOLDER_ID::SEQUENCE:
+					utils::append_number(out, static_cast<unsigned long long>(log_msg.sequence));
+					break;
+				case PLACEHOLDER_ID::ELAPSED:
+					append_elapsed(out, log_msg);
+					break;
+				default:
+					token.formatter->append(out, std::string_view(_template).substr(token.offset, token.length), log_msg);
+					break;
+				}
+			}
+		}
+
+		auto DateFormatter::append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void {
+			//placeholder is d{pattern}
+			utils::thread_date_pattern(placeholder.substr(2, placeholder.size() - 3)).render(out, log_msg.timestamp);
+		}
+
+		auto DateFormatter::get_search_regex() -> std::string {
+			return "d\\{[^\\{\\}]+\\}";
+		}
+
+		auto MessageFormatter::append(std::string& out, std::string_view placeholder, const msg::LogMsg& log_msg) -> void {
+			append_message(out, log_msg, message_escape_mode(placeholder));
+		}
+
+		auto MessageFormatter::get_search_regex() -> std::string {
+			return "\\{msg(:json|:c|:strip)?\\}";
+		}
+
+		auto StackTraceFormatter::append(std::string& out, std::string_view /*placeholder*/, const msg::LogMsg& log_msg) -> void {
+			append_stack_trace(out, log_msg);
+		}
+
+		auto StackTraceFormatter::get_search_regex() -> std::string {
+			return "\\{stacktrace\\}|\\{st\\}";
+		}
+
+		auto LogLevelFormatter::append(std::string& out, std::string_view /*placeholder*/, const msg::LogMsg& log_msg) -> void {
+			append_log_level(out, log_msg.event_type);
+		}
+
+		auto LogLevelFormatter::get_search_regex() -> std::string {
+			return "\\{loglevel\\}|\\{ll\\}";
+		}
+
+		auto NewLineFormatter::append(std::string& out, std::string_view /*placeholder*/, const msg::LogMsg& /*log_msg*/) -> void {
+			out += '\n';
+		}
+
+		auto NewLineFormatter::get_search_regex() -> std::string {
+			return "\\{nl\\}|\\{newline\\}";
+		}
+
+		auto ErrorCodeFormatter::append(std::string& out, std::string_view /*placeholder*/, const msg::LogMsg& log_msg) -> void {
+			append_error_code(out, log_msg);
+		}
+
+		auto ErrorCodeFormatter::get_search_regex() -> std::string {
+			return "\\{errcode\\}|\\{ec\\}";
+		}
+	}
+
+	namespace context
+	{
+		AsyncQueue::AsyncQueue(size_t capacity, OVERFLOW_POLICY policy) : _ring(capacity > 0 ? capacity : 1), _policy(policy) {
+		}
+
+		auto AsyncQueue::_make_room(std::unique_lock<std::mutex>& lock) -> bool {
+			if (_size == _ring.size() && !_stopped)
+			{
+				switch (_policy)
+				{
+				case OVERFLOW_POLICY::BLOCK:
+					//batch pushes notify once at the end, writer has to be woken before waiting for it
+					_not_empty.notify_one();
+					_not_full.wait(lock, [this] { return _size < _ring.size() || _stopped; });
+					break;
+				case OVERFLOW_POLICY::DROP_NEWEST:
+					_dropped_newest.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				case OVERFLOW_POLICY::DROP_OLDEST:
+					_ring[_head].reset();
+					_head = (_head + 1) % _ring.size();
+					_size--;
+					_written++;
+					_dropped_oldest.fetch_add(1, std::memory_order_relaxed);
+					break;
+				}
+			}
+
+			if (_stopped)
+			{
+				_dropped_newest.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+
+			return true;
+		}
+
+		auto AsyncQueue::push(msg::LogMsg log_msg) -> bool {
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			if (!_make_room(lock))
+				return false;
+
+			_ring[(_head + _size) % _ring.size()].emplace(std::move(log_msg));
+			_size++;
+			_pushed++;
+
+			lock.unlock();
+			_not_empty.notify_one();
+
+			return true;
+		}
+
+		auto AsyncQueue::push_batch(const msg::LogMsg* log_msgs, size_t count) -> size_t {
+			std::unique_lock<std::mutex> lock(_mutex);
+			size_t accepted = 0;
+
+			for (size_t i = 0; i < count; i++)
+			{
+				if (!_make_room(lock))
+					continue;
+
+				_ring[(_head + _size) % _ring.size()].emplace(log_msgs[i]);
+				_size++;
+				_pushed++;
+				accepted++;
+			}
+
+			lock.unlock();
+
+			if (accepted > 0)
+				_not_empty.notify_one();
+
+			return accepted;
+		}
+
+		auto AsyncQueue::pop_all(std::vector<msg::LogMsg>& out) -> bool {
+			std::unique_lock<std::mutex> lock(_mutex);
+			_not_empty.wait(lock, [this] { return _size > 0 || _stopped; });
+
+			if (_size == 0)
+				return false;
+
+			for (; _size > 0; _size--)
+			{
+				out.push_back(std::move(*_ring[_head]));
+				_ring[_head].reset();
+				_head = (_head + 1) % _ring.size();
+			}
+
+			lock.unlock();
+			_not_full.notify_all();
+
+			return true;
+		}
+
+		auto AsyncQueue::mark_written(size_t count) -> void {
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				_written += count;
+			}
+
+			_on_written.notify_all();
+		}
+
+		auto AsyncQueue::wait_written() -> void {
+			std::unique_lock<std::mutex> lock(_mutex);
+			std::uint64_t pushed = _pushed;
+
+			_on_written.wait(lock, [this, pushed] { return _written >= pushed || _stopped; });
+		}
+
+		auto AsyncQueue::stop() -> void {
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				_stopped = true;
+			}
+
+			_not_empty.notify_all();
+			_not_full.notify_all();
+			_on_written.notify_all();
+		}
+
+		auto AsyncQueue::get_drop_counters() const -> AsyncDropCounters {
+			return AsyncDropCounters{ _dropped_newest.load(std::memory_order_relaxed), _dropped_oldest.load(std::memory_order_relaxed) };
+		}
+
+		ThreadRing::ThreadRing(size_t capacity) {
+			size_t size = 1;
+
+			while (size < capacity)
+				size *= 2;
+
+			_slots.resize(size);
+			_mask = size - 1;
+		}
+
+		auto ThreadRing::try_push(RingRecord& record) -> bool {
+			size_t tail = _tail.load(std::memory_order_relaxed);
+
+			if (tail - _head.load(std::memory_order_acquire) == _slots.size())
+				return false;
+
+			_slots[tail & _mask].emplace(std::move(record));
+			_tail.store(tail + 1, std::memory_order_release);
+
+			return true;
+		}
+
+		auto ThreadRing::try_push_batch(LoggerContext* context, const msg::LogMsg* log_msgs, size_t count) -> size_t {
+			size_t tail = _tail.load(std::memory_order_relaxed);
+			size_t pushed = (std::min)(count, _slots.size() - (tail - _head.load(std::memory_order_acquire)));
+
+			for (size_t i = 0; i < pushed; i++)
+				_slots[(tail + i) & _mask].emplace(RingRecord{ context, log_msgs[i] });
+
+			_tail.store(tail + pushed, std::memory_order_release);
+
+			return pushed;
+		}
+
+		auto ThreadRing::close() -> void {
+			_closed.store(true, std::memory_order_release);
+		}
+
+		auto ThreadRing::detach() -> void {
+			_detached.store(true, std::memory_order_release);
+		}
+
+		auto ThreadRing::is_detached() const -> bool {
+			return _detached.load(std::memory_order_acquire);
+		}
+
+		auto ThreadRing::get_head() const -> size_t {
+			return _head.load(std::memory_order_relaxed);
+		}
+
+		auto ThreadRing::get_tail() const -> size_t {
+			return _tail.load(std::memory_order_acquire);
+		}
+
+		auto ThreadRing::is_closed() const -> bool {
+			return _closed.load(std::memory_order_acquire);
+		}
+
+		auto ThreadRing::at(size_t position) -> RingRecord& {
+			return *_slots[position & _mask];
+		}
+
+		auto ThreadRing::release(size_t position) -> void {
+			for (size_t i = _head.load(std::memory_order_relaxed); i < position; i++)
+				_slots[i & _mask].reset();
+
+			_head.store(position, std::memory_order_release);
+		}
+
+		RingBackend::RingBackend(size_t ring_capacity, OVERFLOW_POLICY policy) : _ring_capacity(ring_capacity > 0 ? ring_capacity : 1), _policy(policy) {
+			//evicting the oldest record would need the producer to touch slots owned by the consumer
+			if (policy == OVERFLOW_POLICY::DROP_OLDEST)
+				throw exceptions::unsupported_option_exception("DROP_OLDEST is not supported by thread rings");
+
+			//id instead of address, thread local lookups must not match a new backend at a reused address
+			static std::atomic<std::uint64_t> next_id{ 0 };
+			_id = next_id.fetch_add(1, std::memory_order_relaxed);
+
+			_consumer = std::thread([this] { run(); });
+		}
+
+		RingBackend::~RingBackend() {
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				_stopped = true;
+			}
+
+			_wake.notify_all();
+			_consumer.join();
+
+			for (auto& ring : _rings)
+				ring->detach();
+		}
+
+		auto RingBackend::thread_ring() -> ThreadRing& {
+			//closes rings of exiting thread, consumer drains and removes them
+			struct ThreadRings {
+				std::vector<std::pair<std::uint64_t, std::shared_ptr<ThreadRing>>> rings;
+
+				~ThreadRings() {
+					for (auto& ring : rings)
+						ring.second->close();
+				}
+			};
+
+			static thread_local ThreadRings thread_rings;
+
+			//rings of destroyed backends are dropped, so a long living thread doesn't collect them
+			thread_rings.rings.erase(std::remove_if(thread_rings.rings.begin(), thread_rings.rings.end(), [](const std::pair<std::uint64_t, std::shared_ptr<ThreadRing>>& ring) {
+				return ring.second->is_detached();
+			}), thread_rings.rings.end());
+
+			for (auto& ring : thread_rings.rings)
+				if (ring.first == _id)
+					return *ring.second;
+
+			auto ring = std::make_shared<ThreadRing>(_ring_capacity);
+
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				_rings.push_back(ring);
+			}
+
+			thread_rings.rings.emplace_back(_id, ring);
+			return *ring;
+		}
+
+		auto RingBackend::push(LoggerContext* context, msg::LogMsg log_msg) -> void {
+			ThreadRing& ring = thread_ring();
+			RingRecord record{ context, std::move(log_msg) };
+
+			while (!ring.try_push(record))
+			{
+				if (_policy != OVERFLOW_POLICY::BLOCK)
+				{
+					_dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+
+				_wake.notify_one();
+				std::this_thread::yield();
+			}
+		}
+
+		auto RingBackend::push_batch(LoggerContext* context, const msg::LogMsg* log_msgs, size_t count) -> void {
+			ThreadRing& ring = thread_ring();
+
+			while (count > 0)
+			{
+				size_t pushed = ring.try_push_batch(context, log_msgs, count);
+				log_msgs += pushed;
+				count -= pushed;
+
+				if (pushed > 0 || count == 0)
+					continue;
+
+				if (_policy != OVERFLOW_POLICY::BLOCK)
+				{
+					_dropped.fetch_add(count, std::memory_order_relaxed);
+					return;
+				}
+
+				_wake.notify_one();
+				std::this_thread::yield();
+			}
+		}
+
+		//k-way merge of records available at the start of the pass
+		auto RingBackend::drain() -> size_t {
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				_drain_rings.assign(_rings.begin(), _rings.end());
+			}
+
+			_heads.resize(_drain_rings.size());
+			_tails.resize(_drain_rings.size());
+
+			for (size_t i = 0; i < _drain_rings.size(); i++)
+			{
+				_heads[i] = _drain_rings[i]->get_head();
+				_tails[i] = _drain_rings[i]->get_tail();
+			}
+
+			size_t written = 0;
+
+			while (true)
+			{
+				size_t next = _drain_rings.size();
+
+				for (size_t i = 0; i < _drain_rings.size(); i++)
+				{
+					if (_heads[i] == _tails[i])
+						continue;
+
+					if (next == _drain_rings.size() || _drain_rings[i]->at(_heads[i]).log_msg.timestamp < _drain_rings[next]->at(_heads[next]).log_msg.timestamp)
+						next = i;
+				}
+
+				if (next == _drain_rings.size())
+					break;
+
+				RingRecord& record = _drain_rings[next]->at(_heads[next]);
+
+				{
+					std::shared_lock<std::shared_mutex> lock(record.context->strategy_list_mutex);
+					record.context->write(record.log_msg);
+				}
+
+				_drain_rings[next]->release(++_heads[next]);
+				written++;
+			}
+
+			_drain_rings.clear();
+			return written;
+		}
+
+		auto RingBackend::run() -> void {
+			while (true)
 			{
-				MsgFormat format = MsgFormat{log_level_msg_format_cfg["base"]};
-				debug = format;
-				info = format;
-				warning = format;
-				error = format;
-				fatal = format;
+				size_t written = drain();
+
+				{
+					std::unique_lock<std::mutex> lock(_mutex);
+
+					//closed flag is read before tail, so an empty closed ring gets no more records
+					_rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<ThreadRing>& ring) {
+						return ring->is_closed() && ring->get_head() == ring->get_tail();
+					}), _rings.end());
+
+					_on_written.notify_all();
+
+					if (written == 0)
+					{
+						if (_stopped)
+							return;
+
+						_wake.wait_for(lock, std::chrono::milliseconds(1));
+					}
+				}
 			}
+		}
 
-			if (log_level_msg_format_cfg.contains("debug"))
-				debug = MsgFormat{ log_level_msg_format_cfg["debug"] };
+		auto RingBackend::wait_written() -> void {
+			std::unique_lock<std::mutex> lock(_mutex);
 
-			if (log_level_msg_format_cfg.contains("info"))
-				info = MsgFormat{ log_level_msg_format_cfg["info"] };
+			std::vector<std::pair<std::shared_ptr<ThreadRing>, size_t>> targets;
 
-			if (log_level_msg_format_cfg.contains("warning"))
-				warning = MsgFormat{ log_level_msg_format_cfg["warning"] };
+			for (auto& ring : _rings)
+				targets.emplace_back(ring, ring->get_tail());
 
-			if (log_level_msg_format_cfg.contains("error"))
-				error = MsgFormat{ log_level_msg_format_cfg["error"] };
+			_wake.notify_one();
+			_on_written.wait(lock, [&targets] {
+				for (auto& target : targets)
+					if (target.first->get_head() < target.second)
+						return false;
 
-			if (log_level_msg_format_cfg.contains("fatal"))
-				fatal = MsgFormat{ log_level_msg_format_cfg["fatal"] };
+				return true;
+			});
 		}
 
-		LogLevelMsgFormat::LogLevelMsgFormat(
-			MsgFormat debug_format, 
-			MsgFormat info_format,
-			MsgFormat warning_format,
-			MsgFormat error_format,
-			MsgFormat fatal_format) : 
-			debug(debug_format), info(info_format), warning(warning_format), error(error_format), fatal(fatal_format)
-		{
+		auto RingBackend::get_dropped() const -> std::uint64_t {
+			return _dropped.load(std::memory_order_relaxed);
 		}
 
-		auto LogLevelMsgFormat::get_format(LogMsg& log_msg) -> std::string {
-			MsgFormat* msg_format;
+		LoggerContext::LoggerContext(std::shared_ptr<interface::ILogStrategy> strategy) : strategy_list(std::vector{ strategy }) {
+			strategy->attach_context(this);
+			update_effective_min_level();
+		}
 
-			switch (log_msg.event_type)
+		LoggerContext::~LoggerContext() {
+			//pending flush is run before the flusher exits, it waits for the async writer stopped below
 			{
-			case msg::EVENT_TYPE::LOG_DEBUG:
-				msg_format = &debug;
-				break;
-			case msg::EVENT_TYPE::LOG_INFO:
-				msg_format = &info;
-				break;
-			case msg::EVENT_TYPE::LOG_WARNING:
-				msg_format = &warning;
-				break;
-			case msg::EVENT_TYPE::LOG_ERROR:
-				msg_format = &error;
-				break;
-			case msg::EVENT_TYPE::LOG_FATAL:
-				msg_format = &fatal;
-				break;
+				std::lock_guard<std::mutex> lg(flush_mutex);
+				flusher_stopped = true;
 			}
 
-			if (log_msg.has_stack_trace)
-				return msg_format->simple_with_stacktrace;
-			else
-				return msg_format->simple;
-		}
-	}
+			flush_wake.notify_one();
 
-	namespace strategy
-	{
+			if (flusher.joinable())
+				flusher.join();
 
-		FileLogStrategy::FileLogStrategy(string file_path, std::shared_ptr<msg::LogLevelMsgFormat> log_format, size_t buffer_size, scl::formatters_collection addition_formatters) : _buffer_size(buffer_size) {
-			_file_path = file_path;
-			_file_stream = std::ofstream{ file_path, std::ios::app };
-			_log_format = log_format;
+			for (auto& strategy : strategy_list)
+				strategy->detach_context(this);
 
-			utils::FormattersCollectionBuilder formatters_builder{log_format, addition_formatters};
-			formatters_builder.set_avalable<formatter::DateFormatter>();
-			formatters_builder.set_avalable<formatter::MessageFormatter>();
-			formatters_builder.set_avalable<formatter::StackTraceFormatter>();
-			formatters_builder.set_avalable<formatter::LogLevelFormatter>();
-			formatters_builder.set_avalable<formatter::NewLineFormatter>();
-			formatters_builder.set_avalable<formatter::ErrorCodeFormatter>();
-			_formatters = formatters_builder.build();
+			//records of this context still in rings refer to it
+			if (ring_backend_storage)
+				ring_backend_storage->wait_written();
 
-			if (!_file_stream.is_open())
-				throw exceptions::log_file_unawalable_exception("Can't open required file", _file_path);
+			AsyncQueue* queue = async_queue.load(std::memory_order_acquire);
+
+			if (!queue)
+				return;
+
+			//writer drains queued messages before it exits
+			queue->stop();
+			async_writer.join();
 		}
 
-		FileLogStrategy::FileLogStrategy(json& cfg, scl::formatters_collection addition_formatters)
-			: FileLogStrategy(
-				cfg.contains("file_path") ? cfg["file_path"].get<string>() : "./default.log",
-				cfg.contains("log_format") ? std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{ cfg["log_format"] }) : std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}),
-				cfg.contains("buffer_size") ? cfg["buffer_size"].get<size_t>() : 1024,
-				addition_formatters
-			)
-		{ }
+		auto LoggerContext::enable_async(size_t queue_capacity, OVERFLOW_POLICY policy) -> void {
+			std::lock_guard<std::mutex> lg(async_enable_mutex);
 
-		auto FileLogStrategy::log(msg::LogMsg log_msg) -> void {
-			std::string log_format = _log_format->get_format(log_msg);
+			if (async_queue.load(std::memory_order_relaxed))
+				return;
 
-			for (auto& formatter : _formatters)
-				formatter->format(log_format, log_msg);
+			async_queue_storage = std::make_unique<AsyncQueue>(queue_capacity, policy);
+			AsyncQueue* queue = async_queue_storage.get();
 
-			_log_buffer << log_format;
+			async_writer = std::thread([this, queue] {
+				std::vector<msg::LogMsg> batch;
 
-			_actual_buffer_filling += log_format.size();
+				while (queue->pop_all(batch))
+				{
+					{
+						std::shared_lock<std::shared_mutex> lock(strategy_list_mutex);
+						write_batch(batch.data(), batch.size());
+					}
 
-			if (_actual_buffer_filling >= _buffer_size) {
-				_actual_buffer_filling = 0;
+					queue->mark_written(batch.size());
+					batch.clear();
+				}
+
+				std::shared_lock<std::shared_mutex> lock(strategy_list_mutex);
 				flush();
-			}
-		}
-		auto FileLogStrategy::flush() -> void {
-			_file_stream << _log_buffer.str();
-			_file_stream.flush();
-			_log_buffer.str(string());
+			});
+
+			//published once the writer runs, logging threads may pick it up right away
+			async_queue.store(queue, std::memory_order_release);
 		}
 
-		ConsoleLogStrategy::ConsoleLogStrategy(std::shared_ptr<msg::LogLevelMsgFormat> log_format, size_t buffer_size, scl::formatters_collection addition_formatters) : _buffer_size(buffer_size) {
-			_log_format = log_format;
-			
-			utils::FormattersCollectionBuilder formatters_builder{log_format, addition_formatters};
-			formatters_builder.set_avalable<formatter::DateFormatter>();
-			formatters_builder.set_avalable<formatter::MessageFormatter>();
-			formatters_builder.set_avalable<formatter::StackTraceFormatter>();
-			formatters_builder.set_avalable<formatter::LogLevelFormatter>();
-			formatters_builder.set_avalable<formatter::NewLineFormatter>();
-			formatters_builder.set_avalable<formatter::ErrorCodeFormatter>();
-			_formatters = formatters_builder.build();
+		//false if strategy was still locked at deadline, time_point::max() waits without limit
+		static auto lock_until(std::unique_lock<std::timed_mutex>& lock, std::chrono::steady_clock::time_point deadline) -> bool {
+			if (deadline == std::chrono::steady_clock::time_point::max())
+			{
+				lock.lock();
+				return true;
+			}
+
+			return lock.try_lock_until(deadline);
 		}
 
-		ConsoleLogStrategy::ConsoleLogStrategy(json& cfg, scl::formatters_collection addition_formatters) 
-			: ConsoleLogStrategy
-			(
-				cfg.contains("log_format") ? std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{ cfg["log_format"] }) : std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}),
-				cfg.contains("buffer_size") ? cfg["buffer_size"].get<size_t>() : 1024,
-				addition_formatters
-			)
-		{ }
+		//strategies locked by other threads are written after the free ones, so a slow strategy doesn't hold back the rest
+		template<typename WriteT>
+		static auto fan_out(const std::vector<std::shared_ptr<interface::ILogStrategy>>& strategies, WriteT write, std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()) -> void {
+			interface::ILogStrategy* busy[16];
+			size_t busy_count = 0;
 
-		auto ConsoleLogStrategy::log(msg::LogMsg log_msg) -> void {
-			std::string log_format = _log_format->get_format(log_msg);
+			for (auto& strategy : strategies)
+			{
+				std::unique_lock<std::timed_mutex> lock(strategy->get_write_mutex(), std::try_to_lock);
 
-			for (auto& formatter : _formatters)
-				formatter->format(log_format, log_msg);
+				if (!lock.owns_lock())
+				{
+					if (busy_count < std::size(busy))
+					{
+						busy[busy_count++] = strategy.get();
+						continue;
+					}
 
-			_log_buffer << log_format;
+					if (!lock_until(lock, deadline))
+						continue;
+				}
 
-			_actual_buffer_filling += log_format.size();
+				write(*strategy);
+			}
 
-			if (_actual_buffer_filling >= _buffer_size) {
-				_actual_buffer_filling = 0;
-				flush();
+			for (size_t i = 0; i < busy_count; i++)
+			{
+				std::unique_lock<std::timed_mutex> lock(busy[i]->get_write_mutex(), std::defer_lock);
+
+				if (lock_until(lock, deadline))
+					write(*busy[i]);
 			}
 		}
 
-#if defined(WIN32)
-		enum windows_colors
-        {
-            Black       = 0,
-            Grey        = FOREGROUND_INTENSITY,
-            LightGrey   = FOREGROUND_RED   | FOREGROUND_GREEN | FOREGROUND_BLUE,
-            White       = FOREGROUND_RED   | FOREGROUND_GREEN | FOREGROUND_BLUE | FOREGROUND_INTENSITY,
-            Blue        = FOREGROUND_BLUE,
-            Green       = FOREGROUND_GREEN,
-            Cyan        = FOREGROUND_GREEN | FOREGROUND_BLUE,
-            Red         = FOREGROUND_RED,
-            Purple      = FOREGROUND_RED   | FOREGROUND_BLUE,
-            LightBlue   = FOREGROUND_BLUE  | FOREGROUND_INTENSITY,
-            LightGreen  = FOREGROUND_GREEN | FOREGROUND_INTENSITY,
-            LightCyan   = FOREGROUND_GREEN | FOREGROUND_BLUE  | FOREGROUND_INTENSITY,
-            LightRed    = FOREGROUND_RED   | FOREGROUND_INTENSITY,
-            LightPurple = FOREGROUND_RED   | FOREGROUND_BLUE  | FOREGROUND_INTENSITY,
-            Orange      = FOREGROUND_RED   | FOREGROUND_GREEN,
-            Yellow      = FOREGROUND_RED   | FOREGROUND_GREEN | FOREGROUND_INTENSITY,
-        };
-#endif // WIN32
+		auto LoggerContext::write(const msg::LogMsg& log_msg, std::chrono::steady_clock::time_point deadline) -> void {
+			fan_out(strategy_list, [&log_msg](interface::ILogStrategy& strategy) {
+				if (strategy.is_enabled(log_msg.event_type))
+					strategy.log(log_msg);
+			}, deadline);
+		}
 
-		auto ConsoleLogStrategy::flush() -> void {
-			string log = _log_buffer.str();
-			_log_buffer.str(string());
+		auto LoggerContext::write_batch(const msg::LogMsg* log_msgs, size_t count, std::chrono::steady_clock::time_point deadline) -> void {
+			fan_out(strategy_list, [log_msgs, count](interface::ILogStrategy& strategy) {
+				strategy.log_enabled(log_msgs, count);
+			}, deadline);
+		}
 
-			std::regex r{ string("\\{set-color:(\\w+)\\}")};
+		auto LoggerContext::flush() -> void {
+			fan_out(strategy_list, [](interface::ILogStrategy& strategy) {
+				strategy.flush();
+			});
+		}
 
-			const std::vector<std::smatch> matches{
-				std::sregex_iterator{cbegin(log), cend(log), r},
-				std::sregex_iterator{}
-			};
+		auto LoggerContext::start_flush() -> std::shared_ptr<FlushTask> {
+			std::vector<std::shared_ptr<interface::ILogStrategy>> strategies;
 
-			if(matches.empty())
 			{
-				std::cout << log << std::flush;
-				return;
+				std::shared_lock<std::shared_mutex> lock(strategy_list_mutex);
+				strategies = strategy_list;
 			}
-			
-			std::vector<std::string> log_parts = std::vector<string>{
-        		std::sregex_token_iterator(cbegin(log), cend(log), r, -1),
-        		std::sregex_token_iterator()
-			};
 
-			std::cout << log_parts[0] << std::flush;		
+			std::lock_guard<std::mutex> lg(flush_mutex);
 
-#if defined(WIN32)
+			if (!pending_flush)
+				pending_flush = std::make_shared<FlushTask>();
 
-			HANDLE console = GetStdHandle(STD_OUTPUT_HANDLE);
+			pending_flush->set_strategies(std::move(strategies));
+			std::shared_ptr<FlushTask> task = pending_flush;
 
-			for(int i = 0; i < matches.size(); i++){
+			if (!flusher.joinable())
+			{
+				flusher = std::thread([this] {
+					std::unique_lock<std::mutex> lock(flush_mutex);
 
-#define CheckAndSetColor(color, color_name) if(color == std::string(#color_name)) SetConsoleTextAttribute(console, windows_colors::color_name)
+					while (true)
+					{
+						flush_wake.wait(lock, [this] { return pending_flush || flusher_stopped; });
 
-				string color = matches[i][1].str();
+						if (!pending_flush)
+							return;
 
-				CheckAndSetColor(color, Black);
-				CheckAndSetColor(color, Grey);
-				CheckAndSetColor(color, LightGrey);
-				CheckAndSetColor(color, Green);
-				CheckAndSetColor(color, Cyan);
-				CheckAndSetColor(color, Red);
-				CheckAndSetColor(color, Purple);
-				CheckAndSetColor(color, LightBlue);
-				CheckAndSetColor(color, LightGreen);
-				CheckAndSetColor(color, LightCyan);
-				CheckAndSetColor(color, LightRed);
-				CheckAndSetColor(color, LightPurple);
-				CheckAndSetColor(color, Orange);
-				CheckAndSetColor(color, Yellow);
+						std::shared_ptr<FlushTask> next = std::move(pending_flush);
+						pending_flush.reset();
 
-				std::cout << log_parts[i+1] << std::flush;
+						lock.unlock();
+						next->run(*this);
+						lock.lock();
+					}
+				});
 			}
 
-			SetConsoleTextAttribute(console, windows_colors::White);
+			flush_wake.notify_one();
+
+			return task;
+		}
 
-#endif // WIN32		
+		//strategy_list_mutex is never held while the strategy is attached, set_min_level locks in the opposite order
+		auto LoggerContext::add_strategy(std::shared_ptr<interface::ILogStrategy> strategy) -> void {
+			{
+				std::lock_guard<std::shared_mutex> lg(strategy_list_mutex);
+				strategy_list.push_back(strategy);
+			}
 
+			strategy->attach_context(this);
+			update_effective_min_level();
 		}
-	}
 
-	namespace formatter
-	{
-		auto DateFormatter::format(std::string& log_text, msg::LogMsg log_msg) -> void {
-			std::smatch matches;
+		auto LoggerContext::set_min_level(msg::EVENT_TYPE level) -> void {
+			min_level.store(level, std::memory_order_relaxed);
+			update_effective_min_level();
+		}
 
-			if (!std::regex_search(log_text, matches, std::regex{ get_search_regex() }))
-				return;
+		auto LoggerContext::update_effective_min_level() -> void {
+			std::lock_guard<std::mutex> lg(level_mutex);
+			msg::EVENT_TYPE level = min_level.load(std::memory_order_relaxed);
 
-			for (auto& match : matches)
 			{
-				std::string format = match.str();
-				std::string changed_format_str = format.substr(2, format.length() - 3);
+				std::shared_lock<std::shared_mutex> lock(strategy_list_mutex);
 
-				time_t now = time(0);
-				tm* ltm = localtime(&now);
+				if (!strategy_list.empty())
+				{
+					msg::EVENT_TYPE lowest = msg::EVENT_TYPE::LOG_FATAL;
 
-				changed_format_str = std::regex_replace(changed_format_str, std::regex("yyyy"), std::to_string(ltm->tm_year));
-				changed_format_str = std::regex_replace(changed_format_str, std::regex("yy"), std::to_string(ltm->tm_year).substr(2, 2));
-				changed_format_str = std::regex_replace(changed_format_str, std::regex("MM"), std::to_string(ltm->tm_mon));
-				changed_format_str = std::regex_replace(changed_format_str, std::regex("dd"), std::to_string(ltm->tm_mday));
-				changed_format_str = std::regex_replace(changed_format_str, std::regex("hh"), std::to_string(ltm->tm_hour));
-				changed_format_str = std::regex_replace(changed_format_str, std::regex("mm"), std::to_string(ltm->tm_min));
-				changed_format_str = std::regex_replace(changed_format_str, std::regex("ss"), std::to_string(ltm->tm_sec));
+					for (auto& strategy : strategy_list)
+						lowest = (std::min)(lowest, strategy->get_min_level());
 
-				format = std::regex_replace(format, std::regex("\\{"), "\\{");
-				format = std::regex_replace(format, std::regex("\\}"), "\\}");
-				log_text = std::regex_replace(log_text, std::regex(format), changed_format_str);
+					level = (std::max)(level, lowest);
+				}
 			}
-		}
 
-		auto DateFormatter::get_search_regex() -> std::string {
-			return "d\\{[^\\{\\}]+\\}";
+			effective_min_level.store(level, std::memory_order_relaxed);
 		}
 
-		auto MessageFormatter::format(std::string& log_text, msg::LogMsg log_msg) -> void {
-			std::smatch matches;
-
-			std::regex r{ get_search_regex() };
+		auto LoggerContext::wait_async_written() -> void {
+			if (RingBackend* backend = ring_backend.load(std::memory_order_acquire))
+				backend->wait_written();
 
-			if (std::regex_search(log_text, matches, r)) {
-				log_text = std::regex_replace(log_text, r, log_msg.msg);
-			}
+			if (AsyncQueue* queue = async_queue.load(std::memory_order_acquire))
+				queue->wait_written();
 		}
 
-		auto MessageFormatter::get_search_regex() -> std::string {
-			return "\\{msg\\}";
+		auto LoggerContext::attach_ring_backend(std::shared_ptr<RingBackend> backend) -> void {
+			ring_backend_storage = backend;
+			ring_backend.store(backend.get(), std::memory_order_release);
 		}
 
-		auto StackTraceFormatter::format(std::string& log_text, msg::LogMsg log_msg) -> void {
-			std::smatch matches;
-
-			std::regex r{ get_search_regex() };
-
-			if (!std::regex_search(log_text, matches, r))
-				return;
+		auto FlushTask::mark_flushed(const interface::ILogStrategy& strategy) -> void {
+			std::lock_guard<std::mutex> lg(_mutex);
 
-			if (log_msg.has_stack_trace)
-				log_text = std::regex_replace(log_text, r, boost::stacktrace::to_string(log_msg.stack_trace));
-			else
-				log_text = std::regex_replace(log_text, r, "");
+			for (size_t i = 0; i < _strategies.size(); i++)
+				if (_strategies[i].get() == &strategy)
+					_flushed[i] = true;
 		}
 
-		auto StackTraceFormatter::get_search_regex() -> std::string {
-			return "\\{stacktrace\\}|\\{st\\}";
+		auto FlushTask::set_strategies(std::vector<std::shared_ptr<interface::ILogStrategy>> strategies) -> void {
+			std::lock_guard<std::mutex> lg(_mutex);
+			_strategies = std::move(strategies);
+			_flushed.assign(_strategies.size(), false);
 		}
 
-		auto LogLevelFormatter::format(std::string& log_text, msg::LogMsg log_msg) -> void {
-			std::smatch matches;
+		auto FlushTask::run(LoggerContext& context) -> void {
+			context.wait_async_written();
 
-			std::regex r{ get_search_regex() };
+			std::vector<std::shared_ptr<interface::ILogStrategy>> strategies;
 
-			if (!std::regex_search(log_text, matches, r))
-				return;
+			{
+				std::lock_guard<std::mutex> lg(_mutex);
+				strategies = _strategies;
+			}
+
+			fan_out(strategies, [this](interface::ILogStrategy& strategy) {
+				strategy.flush();
+				mark_flushed(strategy);
+			});
+
+			std::vector<std::promise<FlushReport>> promises;
 
-			std::string log_level;
-			switch (log_msg.event_type)
 			{
-			case msg::EVENT_TYPE::LOG_DEBUG:
-				log_level = TO_STRING(EVENT_TYPE::LOG_DEBUG);
-				break;
-			case msg::EVENT_TYPE::LOG_INFO:
-				log_level = TO_STRING(EVENT_TYPE::LOG_INFO);
-				break;
-			case msg::EVENT_TYPE::LOG_WARNING:
-				log_level = TO_STRING(EVENT_TYPE::LOG_WARNING);
-				break;
-			case msg::EVENT_TYPE::LOG_ERROR:
-				log_level = TO_STRING(EVENT_TYPE::LOG_ERROR);
-				break;
-			case msg::EVENT_TYPE::LOG_FATAL:
-				log_level = TO_STRING(EVENT_TYPE::LOG_FATAL);
-				break;
+				std::lock_guard<std::mutex> lg(_mutex);
+				_finished = true;
+				promises.swap(_promises);
 			}
-			log_text = std::regex_replace(log_text, r, log_level);
-		}
 
-		auto LogLevelFormatter::get_search_regex() -> std::string {
-			return "\\{loglevel\\}|\\{ll\\}";
+			_on_finished.notify_all();
+
+			for (auto& promise : promises)
+				promise.set_value(FlushReport{});
 		}
 
-		auto NewLineFormatter::format(std::string& log_text, msg::LogMsg log_msg) -> void {
-			std::smatch matches;
+		auto FlushTask::get_future() -> std::future<FlushReport> {
+			std::promise<FlushReport> promise;
+			std::future<FlushReport> future = promise.get_future();
 
-			std::regex r{ get_search_regex() };
+			std::lock_guard<std::mutex> lg(_mutex);
 
-			if (std::regex_search(log_text, matches, r)) {
-				log_text = std::regex_replace(log_text, r, "\n");
-			}
-		}
+			if (_finished)
+				promise.set_value(FlushReport{});
+			else
+				_promises.push_back(std::move(promise));
 
-		auto NewLineFormatter::get_search_regex() -> std::string {
-			return "\\{nl\\}|\\{newline\\}";
+			return future;
 		}
 
-		auto ErrorCodeFormatter::format(std::string& log_text, msg::LogMsg log_msg) -> void {
-			std::smatch matches;
+		auto FlushTask::wait_until(std::chrono::steady_clock::time_point deadline) -> FlushReport {
+			std::unique_lock<std::mutex> lock(_mutex);
+			_on_finished.wait_until(lock, deadline, [this]() { return _finished; });
 
-			std::regex r{ get_search_regex() };
+			FlushReport report;
+			report.completed = _finished;
 
-			if (std::regex_search(log_text, matches, r)) {
-				if(log_msg.has_error_code)
-					log_text = std::regex_replace(log_text, r, std::to_string(log_msg.error_code));
-				else
-					log_text = std::regex_replace(log_text, r,"");
-			}
-		}
+			for (size_t i = 0; i < _strategies.size(); i++)
+				if (!_flushed[i])
+					report.unfinished.push_back(_strategies[i]);
 
-		auto ErrorCodeFormatter::get_search_regex() -> std::string {
-			return "\\{errcode\\}|\\{ec\\}";
+			return report;
 		}
 	}
 
 	namespace logger
 	{
 		auto Logger::_log(msg::LogMsg log_msg) -> void {
-			std::lock_guard<std::mutex> lg(_logger_context->write_mutex);
+			if (context::RingBackend* ring_backend = _logger_context->ring_backend.load(std::memory_order_acquire))
+			{
+				ring_backend->push(_logger_context.get(), std::move(log_msg));
+				return;
+			}
+
+			if (context::AsyncQueue* async_queue = _logger_context->async_queue.load(std::memory_order_acquire))
+			{
+				async_queue->push(std::move(log_msg));
+				return;
+			}
 
-			for (auto strategy : _logger_context->strategy_list)
-				strategy->log(log_msg);
+			std::shared_lock<std::shared_mutex> lock(_logger_context->strategy_list_mutex);
+			_logger_context->write(log_msg);
 		}
 
 		auto Logger::_flush() -> void {
-			std::lock_guard<std::mutex> lg(_logger_context->write_mutex);
+			_logger_context->wait_async_written();
+
+			std::shared_lock<std::shared_mutex> lock(_logger_context->strategy_list_mutex);
+			_logger_context->flush();
+		}
+
+		auto Logger::_log_fatal(msg::LogMsg log_msg) -> void {
+			auto deadline = std::chrono::steady_clock::now() + _logger_context->fatal_flush_timeout.load(std::memory_order_relaxed);
 
-			for (auto strategy : _logger_context->strategy_list)
-				strategy->flush();
+			if (_logger_context->ring_backend.load(std::memory_order_acquire) || _logger_context->async_queue.load(std::memory_order_acquire))
+			{
+				_log(std::move(log_msg));
+			}
+			else
+			{
+				std::shared_lock<std::shared_mutex> lock(_logger_context->strategy_list_mutex);
+				_logger_context->write(log_msg, deadline);
+			}
+
+			flush_until(deadline);
 		}
 
 		auto Logger::_add_strategy(std::shared_ptr<interface::ILogStrategy> strategy) -> void {
-			std::lock_guard<std::mutex> lg(_logger_context->write_mutex);
-			_logger_context->strategy_list.push_back(strategy);
+			_logger_context->add_strategy(strategy);
 		}
 
 		//logger with logging in log_section
 		Logger::Logger(std::shared_ptr<context::LoggerContext> context) : interface::ILogger(context) {
+			//{elapsed} is counted from the first logger
+			utils::start_time();
 		}
 
 		Logger::~Logger() { flush(); }
@@ -489,8 +2060,11 @@ namespace scl
 		//log debug to corrent logger
 		auto Logger::log_debug(string msg, bool is_need_stack_trace = false) -> void {
 #if defined(_DEBUG) || defined(DEBUG)
+			if (!is_enabled(msg::EVENT_TYPE::LOG_DEBUG))
+				return;
+
 			msg::LogMsg log_msg{
-				msg,
+				std::move(msg),
 				msg::EVENT_TYPE::LOG_DEBUG,
 				false,
 				0,
@@ -500,14 +2074,17 @@ namespace scl
 			if (is_need_stack_trace)
 				log_msg.stack_trace = boost::stacktrace::stacktrace();
 
-			_log(log_msg);
+			_log(std::move(log_msg));
 #endif // _DEBUG 
 		}
 
 		//log info to corrent logger
 		auto Logger::log_info(string msg, bool is_need_stack_trace = false) -> void {
+			if (!is_enabled(msg::EVENT_TYPE::LOG_INFO))
+				return;
+
 			msg::LogMsg log_msg{
-				msg,
+				std::move(msg),
 				msg::EVENT_TYPE::LOG_INFO,
 				false,
 				0,
@@ -517,13 +2094,16 @@ namespace scl
 			if (is_need_stack_trace)
 				log_msg.stack_trace = boost::stacktrace::stacktrace();
 
-			_log(log_msg);
+			_log(std::move(log_msg));
 		}
 
 		//log debug to corrent logger
 		auto Logger::log_warning(string msg, bool is_need_stack_trace = true) -> void {
+			if (!is_enabled(msg::EVENT_TYPE::LOG_WARNING))
+				return;
+
 			msg::LogMsg log_msg{
-				msg,
+				std::move(msg),
 				msg::EVENT_TYPE::LOG_WARNING,
 				false,
 				0,
@@ -533,13 +2113,16 @@ namespace scl
 			if (is_need_stack_trace)
 				log_msg.stack_trace = boost::stacktrace::stacktrace();
 
-			_log(log_msg);
+			_log(std::move(log_msg));
 		}
 
 		//log error to corrent logger
 		auto Logger::log_error(string msg, bool is_need_stack_trace = true) -> void {
+			if (!is_enabled(msg::EVENT_TYPE::LOG_ERROR))
+				return;
+
 			msg::LogMsg log_msg{
-				msg,
+				std::move(msg),
 				msg::EVENT_TYPE::LOG_ERROR,
 				false,
 				0,
@@ -549,13 +2132,16 @@ namespace scl
 			if (is_need_stack_trace)
 				log_msg.stack_trace = boost::stacktrace::stacktrace();
 
-			_log(log_msg);
+			_log(std::move(log_msg));
 		}
 
 		//log fatal to corrent logger
 		auto Logger::log_fatal(string msg, int error_code, bool is_need_stack_trace = true) -> void {
+			if (!is_enabled(msg::EVENT_TYPE::LOG_FATAL))
+				return;
+
 			msg::LogMsg log_msg{
-				msg,
+				std::move(msg),
 				msg::EVENT_TYPE::LOG_FATAL,
 				true,
 				error_code,
@@ -565,14 +2151,103 @@ namespace scl
 			if (is_need_stack_trace)
 				log_msg.stack_trace = boost::stacktrace::stacktrace();
 
-			_log(log_msg);
-			_flush();
+			_log_fatal(std::move(log_msg));
+		}
+
+		auto Logger::log(msg::LogMsg log_msg) -> void {
+			if (!is_enabled(log_msg.event_type))
+				return;
+
+			if (log_msg.has_stack_trace && log_msg.stack_trace.empty())
+				log_msg.stack_trace = boost::stacktrace::stacktrace();
+
+			if (log_msg.event_type == msg::EVENT_TYPE::LOG_FATAL)
+				_log_fatal(std::move(log_msg));
+			else
+				_log(std::move(log_msg));
+		}
+
+		//passes runs of enabled records as they are, records needing a stack trace are copied and captured on the calling thread
+		template<typename IsEnabledT, typename WriteRunT, typename WriteOneT>
+		static auto split_batch(const msg::LogMsg* log_msgs, size_t count, IsEnabledT is_enabled, WriteRunT write_run, WriteOneT write_one) -> void {
+			size_t run_begin = 0;
+
+			for (size_t i = 0; i <= count; i++)
+			{
+				bool is_passed = i < count && is_enabled(log_msgs[i].event_type);
+				bool is_captured = is_passed && log_msgs[i].has_stack_trace && log_msgs[i].stack_trace.empty();
+
+				if (is_passed && !is_captured)
+					continue;
+
+				if (i > run_begin)
+					write_run(log_msgs + run_begin, i - run_begin);
+
+				run_begin = i + 1;
+
+				if (is_captured)
+				{
+					msg::LogMsg log_msg = log_msgs[i];
+					log_msg.stack_trace = boost::stacktrace::stacktrace();
+					write_one(std::move(log_msg));
+				}
+			}
+		}
+
+		auto Logger::log_batch(const msg::LogMsg* log_msgs, size_t count) -> void {
+			context::LoggerContext* logger_context = _logger_context.get();
+			auto is_level_enabled = [this](msg::EVENT_TYPE level) {
+				return is_enabled(level);
+			};
+			bool has_fatal = std::any_of(log_msgs, log_msgs + count, [this](const msg::LogMsg& log_msg) {
+				return log_msg.event_type == msg::EVENT_TYPE::LOG_FATAL && is_enabled(log_msg.event_type);
+			});
+			//batch with a fatal message is bounded like log_fatal
+			auto deadline = has_fatal ? std::chrono::steady_clock::now() + logger_context->fatal_flush_timeout.load(std::memory_order_relaxed) : std::chrono::steady_clock::time_point::max();
+
+			if (context::RingBackend* ring_backend = logger_context->ring_backend.load(std::memory_order_acquire))
+			{
+				split_batch(log_msgs, count, is_level_enabled, [ring_backend, logger_context](const msg::LogMsg* run, size_t run_count) {
+					ring_backend->push_batch(logger_context, run, run_count);
+				}, [ring_backend, logger_context](msg::LogMsg log_msg) {
+					ring_backend->push(logger_context, std::move(log_msg));
+				});
+			}
+			else if (context::AsyncQueue* async_queue = logger_context->async_queue.load(std::memory_order_acquire))
+			{
+				split_batch(log_msgs, count, is_level_enabled, [async_queue](const msg::LogMsg* run, size_t run_count) {
+					async_queue->push_batch(run, run_count);
+				}, [async_queue](msg::LogMsg log_msg) {
+					async_queue->push(std::move(log_msg));
+				});
+			}
+			else
+			{
+				std::shared_lock<std::shared_mutex> lock(logger_context->strategy_list_mutex);
+
+				split_batch(log_msgs, count, is_level_enabled, [logger_context, deadline](const msg::LogMsg* run, size_t run_count) {
+					logger_context->write_batch(run, run_count, deadline);
+				}, [logger_context, deadline](msg::LogMsg log_msg) {
+					logger_context->write(log_msg, deadline);
+				});
+			}
+
+			if (has_fatal)
+				flush_until(deadline);
 		}
 
 		auto Logger::flush() -> void {
 			_flush();
 		}
 
+		auto Logger::flush_async() -> std::future<context::FlushReport> {
+			return _logger_context->start_flush()->get_future();
+		}
+
+		auto Logger::flush_until(std::chrono::steady_clock::time_point deadline) -> context::FlushReport {
+			return _logger_context->start_flush()->wait_until(deadline);
+		}
+
 		auto Logger::add_strategy(std::shared_ptr<interface::ILogStrategy> strategy = std::shared_ptr<interface::ILogStrategy>(new strategy::FileLogStrategy{})) -> void {
 			_add_strategy(strategy);
 		}
@@ -587,19 +2262,45 @@ namespace scl
 		LoggerManager::~LoggerManager() {
 			flush_all();
 
+			//loggers may outlive manager, they fall back to synchronous writes
+			//calls already inside the backend are safe, every context keeps it alive
+			for (auto& logger_context : _logger_context_map)
+				logger_context.second->ring_backend.store(nullptr, std::memory_order_release);
+
+			_ring_backend.reset();
+
 			delete _modify_context_collection_mx;
 		}
 
 		auto LoggerManager::flush_all() -> void {
-			for (auto logger_context : _logger_context_map)
+			for (auto& logger_context : _logger_context_map)
 			{
-				auto log_info = logger_context.second;
+				auto& log_info = logger_context.second;
+
+				log_info->wait_async_written();
+
+				std::shared_lock<std::shared_mutex> lock(log_info->strategy_list_mutex);
+				log_info->flush();
+			}
+		}
 
-				std::lock_guard<std::mutex> lg(log_info->write_mutex);
+		auto LoggerManager::flush_all_until(std::chrono::steady_clock::time_point deadline) -> context::FlushReport {
+			std::vector<std::shared_ptr<context::FlushTask>> tasks;
 
-				for (auto strategy : log_info->strategy_list)
-					strategy->flush();
+			for (auto& logger_context : _logger_context_map)
+				tasks.push_back(logger_context.second->start_flush());
+
+			context::FlushReport report;
+
+			for (auto& task : tasks)
+			{
+				auto task_report = task->wait_until(deadline);
+
+				report.completed = report.completed && task_report.completed;
+				report.unfinished.insert(report.unfinished.end(), task_report.unfinished.begin(), task_report.unfinished.end());
 			}
+
+			return report;
 		}
 
 		auto LoggerManager::create_logger(string log_name, std::shared_ptr<interface::ILogStrategy> strategy = std::shared_ptr<interface::ILogStrategy>(new strategy::FileLogStrategy{}), bool throw_if_exist = true) -> void {
@@ -614,6 +2315,8 @@ namespace scl
 			std::lock_guard<std::mutex> lg(*_modify_context_collection_mx);
 
 			_logger_context_map[log_name] = std::shared_ptr<context::LoggerContext>(new context::LoggerContext(strategy));
+			if (_ring_backend)
+				_logger_context_map[log_name]->attach_ring_backend(_ring_backend);
 		}
 
 		auto LoggerManager::is_logger_exist(std::string log_name, bool need_create_if_not_exist = false, std::shared_ptr<interface::ILogStrategy> strategy = std::shared_ptr<interface::ILogStrategy>(new strategy::FileLogStrategy{})) -> bool {
@@ -623,7 +2326,11 @@ namespace scl
 			std::lock_guard<std::mutex> lg(*_modify_context_collection_mx);
 
 			if (need_create_if_not_exist)
+			{
 				_logger_context_map[log_name] = std::shared_ptr<context::LoggerContext>(new context::LoggerContext(strategy));
+				if (_ring_backend)
+					_logger_context_map[log_name]->attach_ring_backend(_ring_backend);
+			}
 
 			return false;
 		}
@@ -631,10 +2338,40 @@ namespace scl
 		auto LoggerManager::get_logger(std::string log_name) -> std::shared_ptr<interface::ILogger> {
 			auto context = _logger_context_map[log_name];
 
-			std::lock_guard<std::mutex> lg(context->write_mutex);
+			std::lock_guard<std::shared_mutex> lg(context->strategy_list_mutex);
 
 			interface::ILogger* logger = new logger::Logger(std::shared_ptr<context::LoggerContext>(context));
 			return std::shared_ptr<interface::ILogger>(logger);
 		}
+
+		auto LoggerManager::enable_async(std::string log_name, size_t queue_capacity = 8192, context::OVERFLOW_POLICY policy = context::OVERFLOW_POLICY::BLOCK) -> void {
+			std::lock_guard<std::mutex> lg(*_modify_context_collection_mx);
+
+			_logger_context_map.at(log_name)->enable_async(queue_capacity, policy);
+		}
+
+		auto LoggerManager::get_async_drop_counters(std::string log_name) -> context::AsyncDropCounters {
+			auto& context = _logger_context_map.at(log_name);
+
+			context::AsyncQueue* async_queue = context->async_queue.load(std::memory_order_acquire);
+
+			return async_queue ? async_queue->get_drop_counters() : context::AsyncDropCounters{};
+		}
+
+		auto LoggerManager::enable_thread_rings(size_t ring_capacity = 4096, context::OVERFLOW_POLICY policy = context::OVERFLOW_POLICY::BLOCK) -> void {
+			std::lock_guard<std::mutex> lg(*_modify_context_collection_mx);
+
+			if (_ring_backend)
+				return;
+
+			_ring_backend = std::make_shared<context::RingBackend>(ring_capacity, policy);
+
+			for (auto& logger_context : _logger_context_map)
+				logger_context.second->attach_ring_backend(_ring_backend);
+		}
+
+		auto LoggerManager::get_thread_rings_dropped() -> std::uint64_t {
+			return _ring_backend ? _ring_backend->get_dropped() : 0;
+		}
 	}
 }
\ No newline at end of file
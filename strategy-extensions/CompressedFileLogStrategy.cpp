@@ -0,0 +1,368 @@
+#include "CompressedFileLogStrategy.hpp"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+
+namespace scl::extensions {
+
+    static constexpr size_t hash_bits = 14;
+    static constexpr size_t min_match = 4;
+    //the tail of a block is always written as literals, like in LZ4
+    static constexpr size_t last_literals = 12;
+    static constexpr size_t max_offset = 65535;
+    //larger sizes in a header mean it is damaged
+    static constexpr std::uint32_t max_block_size = 1u << 30;
+
+    static auto fnv1a(const char* data, size_t size) -> std::uint32_t {
+        std::uint32_t hash = 2166136261u;
+
+        for (size_t i = 0; i < size; i++)
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 16777619u;
+
+        return hash;
+    }
+
+    static auto put_u32(char* out, std::uint32_t value) -> void {
+        for (size_t i = 0; i < 4; i++)
+            out[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+
+    static auto get_u32(const char* data) -> std::uint32_t {
+        std::uint32_t value = 0;
+
+        for (size_t i = 0; i < 4; i++)
+            value |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[i])) << (i * 8);
+
+        return value;
+    }
+
+    static auto parse_header(const char* data, CompressedBlockHeader& header) -> bool {
+        if (get_u32(data) != CompressedBlockHeader::magic)
+            return false;
+
+        header.codec_id = get_u32(data + 4);
+        header.raw_size = get_u32(data + 8);
+        header.stored_size = get_u32(data + 12);
+        header.checksum = get_u32(data + 16);
+
+        return header.raw_size <= max_block_size && header.stored_size <= max_block_size;
+    }
+
+    static auto append_length(std::string& out, size_t length) -> void {
+        for (; length >= 255; length -= 255)
+            out.push_back(static_cast<char>(255));
+
+        out.push_back(static_cast<char>(length));
+    }
+
+    static auto read_length(const unsigned char*& in, const unsigned char* end, size_t& length) -> bool {
+        while (in < end)
+        {
+            unsigned char part = *in++;
+            length += part;
+
+            if (part != 255)
+                return true;
+        }
+
+        return false;
+    }
+
+    //token: literal count and match length - 4 in nibbles, 15 means the rest follows in 255 runs
+    static auto append_sequence(std::string& out, const char* literals, size_t literal_count, size_t offset, size_t match_length) -> void {
+        size_t match_code = match_length - min_match;
+
+        out.push_back(static_cast<char>((std::min<size_t>(literal_count, 15) << 4) | std::min<size_t>(match_code, 15)));
+
+        if (literal_count >= 15)
+            append_length(out, literal_count - 15);
+
+        out.append(literals, literal_count);
+        out.push_back(static_cast<char>(offset & 0xFF));
+        out.push_back(static_cast<char>(offset >> 8));
+
+        if (match_code >= 15)
+            append_length(out, match_code - 15);
+    }
+
+    auto LzCodec::get_id() const -> std::uint32_t {
+        return id;
+    }
+
+    auto LzCodec::compress(const char* data, size_t size, std::string& out) -> void {
+        _hash_table.assign(size_t(1) << hash_bits, 0);
+
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+        size_t match_limit = size > last_literals ? size - last_literals : 0;
+        size_t anchor = 0;
+        size_t position = 0;
+
+        while (position < match_limit)
+        {
+            std::uint32_t sequence;
+            std::memcpy(&sequence, in + position, sizeof(sequence));
+
+            std::uint32_t hash = (sequence * 2654435761u) >> (32 - hash_bits);
+            //positions are stored + 1, zero is an empty slot
+            size_t candidate = _hash_table[hash];
+            _hash_table[hash] = static_cast<std::uint32_t>(position + 1);
+
+            if (candidate == 0 || position - (candidate - 1) > max_offset || std::memcmp(in + candidate - 1, in + position, min_match) != 0)
+            {
+                //incompressible data is skipped faster the longer no match is found
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            size_t match = candidate - 1;
+            size_t length = min_match;
+
+            while (position + length < size && in[match + length] == in[position + length])
+                length++;
+
+            append_sequence(out, data + anchor, position - anchor, position - match, length);
+
+            position += length;
+            anchor = position;
+        }
+
+        size_t literal_count = size - anchor;
+        out.push_back(static_cast<char>(std::min<size_t>(literal_count, 15) << 4));
+
+        if (literal_count >= 15)
+            append_length(out, literal_count - 15);
+
+        out.append(data + anchor, literal_count);
+    }
+
+    auto LzCodec::decompress(const char* data, size_t size, size_t raw_size, std::string& out) -> bool {
+        const unsigned char* in = reinterpret_cast<const unsigned char*>(data);
+        const unsigned char* end = in + size;
+        size_t begin = out.size();
+
+        //matches are copied from out itself, it must not reallocate
+        out.reserve(begin + raw_size);
+
+        while (in < end)
+        {
+            unsigned char token = *in++;
+            size_t literal_count = token >> 4;
+
+            if (literal_count == 15 && !read_length(in, end, literal_count))
+                return false;
+
+            if (static_cast<size_t>(end - in) < literal_count || out.size() - begin + literal_count > raw_size)
+                return false;
+
+            out.append(reinterpret_cast<const char*>(in), literal_count);
+            in += literal_count;
+
+            //the last sequence has literals only
+            if (in == end)
+                break;
+
+            if (end - in < 2)
+                return false;
+
+            size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+            in += 2;
+
+            size_t length = token & 15;
+
+            if (length == 15 && !read_length(in, end, length))
+                return false;
+
+            length += min_match;
+
+            size_t produced = out.size() - begin;
+
+            if (offset == 0 || offset > produced || produced + length > raw_size)
+                return false;
+
+            size_t from = out.size() - offset;
+
+            if (offset >= length)
+                out.append(out.data() + from, length);
+            else
+                for (size_t i = 0; i < length; i++)
+                    out.push_back(out[from + i]);
+        }
+
+        return out.size() - begin == raw_size;
+    }
+
+    auto decompress_log(std::istream& in, std::ostream& out, const std::vector<std::shared_ptr<ICompressionCodec>>& codecs) -> DECOMPRESS_RESULT {
+        char header_bytes[CompressedBlockHeader::size];
+        CompressedBlockHeader header;
+        std::string stored;
+        std::string raw;
+
+        while (true)
+        {
+            in.read(header_bytes, sizeof(header_bytes));
+
+            if (in.gcount() == 0)
+                return DECOMPRESS_RESULT::COMPLETE;
+
+            if (static_cast<size_t>(in.gcount()) < sizeof(header_bytes))
+                return DECOMPRESS_RESULT::TRUNCATED;
+
+            if (!parse_header(header_bytes, header))
+                return DECOMPRESS_RESULT::DAMAGED;
+
+            stored.resize(header.stored_size);
+            in.read(&stored[0], header.stored_size);
+
+            if (static_cast<size_t>(in.gcount()) < header.stored_size)
+                return DECOMPRESS_RESULT::TRUNCATED;
+
+            if (fnv1a(stored.data(), stored.size()) != header.checksum)
+                return DECOMPRESS_RESULT::DAMAGED;
+
+            if (header.codec_id == CompressedBlockHeader::stored_codec_id)
+            {
+                if (header.stored_size != header.raw_size)
+                    return DECOMPRESS_RESULT::DAMAGED;
+
+                out.write(stored.data(), stored.size());
+                continue;
+            }
+
+            auto codec = std::find_if(codecs.begin(), codecs.end(), [&header](const std::shared_ptr<ICompressionCodec>& codec) {
+                return codec->get_id() == header.codec_id;
+            });
+
+            raw.clear();
+
+            if (codec == codecs.end() || !(*codec)->decompress(stored.data(), stored.size(), header.raw_size, raw))
+                return DECOMPRESS_RESULT::DAMAGED;
+
+            out.write(raw.data(), raw.size());
+        }
+    }
+
+    //true if everything from offset to the end of file is zero
+    static auto is_zero_tail(std::ifstream& in, std::uintmax_t offset, std::uintmax_t file_size) -> bool {
+        char chunk[4096];
+
+        in.clear();
+        in.seekg(static_cast<std::streamoff>(offset));
+
+        while (offset < file_size)
+        {
+            size_t part = static_cast<size_t>(std::min<std::uintmax_t>(sizeof(chunk), file_size - offset));
+
+            if (!in.read(chunk, static_cast<std::streamsize>(part)) || std::any_of(chunk, chunk + part, [](char c) { return c != 0; }))
+                return false;
+
+            offset += part;
+        }
+
+        return true;
+    }
+
+    BlockCompressionEncoder::BlockCompressionEncoder(std::shared_ptr<ICompressionCodec> codec) : _codec(codec) {
+    }
+
+    auto BlockCompressionEncoder::encode(const std::string& raw, std::string& out) -> void {
+        std::uint32_t codec_id = _codec->get_id();
+        size_t header_offset = out.size();
+
+        out.append(CompressedBlockHeader::size, '\0');
+        _codec->compress(raw.data(), raw.size(), out);
+
+        //data that doesn't shrink is stored as is
+        if (out.size() - header_offset - CompressedBlockHeader::size >= raw.size())
+        {
+            out.resize(header_offset + CompressedBlockHeader::size);
+            out.append(raw);
+            codec_id = CompressedBlockHeader::stored_codec_id;
+        }
+
+        char* header = &out[header_offset];
+        size_t stored_size = out.size() - header_offset - CompressedBlockHeader::size;
+
+        put_u32(header, CompressedBlockHeader::magic);
+        put_u32(header + 4, codec_id);
+        put_u32(header + 8, static_cast<std::uint32_t>(raw.size()));
+        put_u32(header + 12, static_cast<std::uint32_t>(stored_size));
+        put_u32(header + 16, fnv1a(header + CompressedBlockHeader::size, stored_size));
+    }
+
+    auto BlockCompressionEncoder::prepare_file(const std::string& file_path) -> void {
+        std::error_code error;
+        std::uintmax_t file_size = std::filesystem::file_size(file_path, error);
+
+        if (error)
+            return;
+
+        std::ifstream in(file_path, std::ios::binary);
+        char header_bytes[CompressedBlockHeader::size];
+        CompressedBlockHeader header;
+        std::uintmax_t valid_size = 0;
+        std::uintmax_t last_block = 0;
+        bool has_blocks = false;
+
+        //blocks are written one by one, so a crash can leave at most one partial block at the end
+        while (file_size - valid_size >= CompressedBlockHeader::size)
+        {
+            in.seekg(static_cast<std::streamoff>(valid_size));
+
+            if (!in.read(header_bytes, sizeof(header_bytes)))
+                return;
+
+            if (!parse_header(header_bytes, header))
+            {
+                if (!is_zero_tail(in, valid_size, file_size))
+                    return;
+
+                break;
+            }
+
+            if (valid_size + CompressedBlockHeader::size + header.stored_size > file_size)
+                break;
+
+            last_block = valid_size;
+            has_blocks = true;
+            valid_size += CompressedBlockHeader::size + header.stored_size;
+        }
+
+        //file system may keep the size of the last block without its data
+        if (has_blocks)
+        {
+            in.clear();
+            in.seekg(static_cast<std::streamoff>(last_block));
+            in.read(header_bytes, sizeof(header_bytes));
+            parse_header(header_bytes, header);
+
+            std::string stored(header.stored_size, '\0');
+            in.read(&stored[0], header.stored_size);
+
+            if (!in || fnv1a(stored.data(), stored.size()) != header.checksum)
+                valid_size = last_block;
+        }
+
+        in.close();
+
+        if (valid_size < file_size)
+            std::filesystem::resize_file(file_path, valid_size, error);
+    }
+
+    CompressedFileLogStrategy::CompressedFileLogStrategy(std::string file_path, std::shared_ptr<msg::LogLevelMsgFormat> log_format, size_t block_size, std::shared_ptr<ICompressionCodec> codec, scl::formatters_collection addition_formatters, scl::strategy::RotationPolicy rotation)
+        : scl::strategy::FileLogStrategy(file_path, log_format, std::min<size_t>(block_size, max_block_size / 2), addition_formatters, rotation, std::make_shared<BlockCompressionEncoder>(codec)) {
+    }
+
+    CompressedFileLogStrategy::CompressedFileLogStrategy(json& cfg, scl::formatters_collection addition_formatters)
+        : CompressedFileLogStrategy(
+            cfg.contains("file_path") ? cfg["file_path"].get<std::string>() : "./default.log.sclz",
+            cfg.contains("log_format") ? std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{ cfg["log_format"] }) : std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}),
+            cfg.contains("block_size") ? cfg["block_size"].get<size_t>() : 256 * 1024,
+            std::make_shared<LzCodec>(),
+            addition_formatters,
+            cfg.contains("rotation") ? scl::strategy::RotationPolicy::from_json(cfg["rotation"]) : scl::strategy::RotationPolicy{}
+        )
+    {
+        if (cfg.contains("min_level"))
+            set_min_level(msg::event_type_from_string(cfg["min_level"].get<std::string>()));
+    }
+}
@@ -0,0 +1,89 @@
+#ifndef compressed_file_log_strategy
+#define compressed_file_log_strategy
+
+#include "../include/SimpleCppLogger.hpp"
+#include <memory>
+#include <cstdint>
+
+namespace scl::extensions {
+
+	class ICompressionCodec
+	{
+	public:
+		virtual ~ICompressionCodec() {}
+		//stored in every block, 0 is reserved for blocks written uncompressed
+		virtual auto get_id() const -> std::uint32_t = 0;
+		//appends compressed data to out
+		virtual auto compress(const char* data, size_t size, std::string& out) -> void = 0;
+		//appends raw data to out, false if data is damaged or doesn't decompress to raw_size bytes
+		virtual auto decompress(const char* data, size_t size, size_t raw_size, std::string& out) -> bool = 0;
+	};
+
+	//byte oriented LZ77 in the LZ4 block layout, fast enough to keep up with the logger on one core
+	class LzCodec : public ICompressionCodec
+	{
+	private:
+		std::vector<std::uint32_t> _hash_table;
+
+	public:
+		static constexpr std::uint32_t id = 1;
+
+		auto get_id() const -> std::uint32_t override;
+		auto compress(const char* data, size_t size, std::string& out) -> void override;
+		auto decompress(const char* data, size_t size, size_t raw_size, std::string& out) -> bool override;
+	};
+
+	//block frame: magic, codec id, raw size, stored size, FNV-1a of stored data (all little endian u32), stored data
+	struct CompressedBlockHeader
+	{
+		static constexpr std::uint32_t magic = 0x4B4C4353; //"SCLK"
+		static constexpr size_t size = 20;
+		static constexpr std::uint32_t stored_codec_id = 0;
+
+		std::uint32_t codec_id = stored_codec_id;
+		std::uint32_t raw_size = 0;
+		std::uint32_t stored_size = 0;
+		std::uint32_t checksum = 0;
+	};
+
+	enum class DECOMPRESS_RESULT
+	{
+		COMPLETE,
+		//file ends inside a block, e.g. writer crashed, everything before it was written out
+		TRUNCATED,
+		//bad checksum, unknown codec or undecodable block, everything before it was written out
+		DAMAGED,
+	};
+
+	//writes raw log of every complete block to out, stops at the first incomplete or damaged block
+	auto decompress_log(std::istream& in, std::ostream& out, const std::vector<std::shared_ptr<ICompressionCodec>>& codecs = { std::make_shared<LzCodec>() }) -> DECOMPRESS_RESULT;
+
+	//compresses every buffer of FileLogStrategy into one block
+	class BlockCompressionEncoder : public scl::interface::IFileEncoder
+	{
+	private:
+		std::shared_ptr<ICompressionCodec> _codec;
+
+	public:
+		BlockCompressionEncoder(std::shared_ptr<ICompressionCodec> codec = std::make_shared<LzCodec>());
+
+		auto encode(const std::string& raw, std::string& out) -> void override;
+		//cuts off a torn tail, so blocks appended after a crash stay readable:
+		//a partial block, zeros left by the file system or a last block with bad checksum
+		//damage followed by other data is left as is, decompress_log stops there
+		auto prepare_file(const std::string& file_path) -> void override;
+	};
+
+	//FileLogStrategy writing independently compressed blocks of block_size raw bytes, compression runs on the writer thread
+	//rotation works as for plain files, rotated files keep the block format
+	class CompressedFileLogStrategy : public scl::strategy::FileLogStrategy
+	{
+	public:
+		CompressedFileLogStrategy(std::string file_path = "./default.log.sclz", std::shared_ptr<msg::LogLevelMsgFormat> log_format = std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}), size_t block_size = 256 * 1024, std::shared_ptr<ICompressionCodec> codec = std::make_shared<LzCodec>(), scl::formatters_collection addition_formatters = scl::formatters_collection{}, scl::strategy::RotationPolicy rotation = scl::strategy::RotationPolicy{});
+		//fields: file_path, log_format, block_size, rotation, min_level
+		CompressedFileLogStrategy(json& cfg, scl::formatters_collection addition_formatters = scl::formatters_collection{});
+	};
+
+}
+
+#endif //compressed_file_log_strategy
@@ -29,9 +29,15 @@ namespace scl::extensions {
         }
     }
 
-    auto ConfigurableLoggerStrategy::log(msg::LogMsg log_msg) -> void {
+    auto ConfigurableLoggerStrategy::log(const msg::LogMsg& log_msg) -> void {
         for(auto &logger : _log_strategy_collection)
-            logger->log(log_msg);
+            if (logger->is_enabled(log_msg.event_type))
+                logger->log(log_msg);
+    }
+
+    auto ConfigurableLoggerStrategy::log_batch(const msg::LogMsg* log_msgs, size_t count) -> void {
+        for(auto &logger : _log_strategy_collection)
+            logger->log_enabled(log_msgs, count);
     }
 
     auto ConfigurableLoggerStrategy::flush() -> void {
@@ -13,7 +13,9 @@ namespace scl::extensions {
 	public:
 		ConfigurableLoggerStrategy(std::string configuration_file_path);
 
-		auto log(msg::LogMsg log_msg) -> void override;
+		auto log(const msg::LogMsg& log_msg) -> void override;
+
+		auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void override;
 
         auto flush() -> void override;
 	};
@@ -0,0 +1,401 @@
+#include "IoUringLogStrategy.hpp"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+//without the header (old kernel headers, some libc only toolchains) the strategy always writes with pwrite
+#if defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define SCL_IO_URING_HEADER
+#endif
+#endif
+
+#if defined(SCL_IO_URING_HEADER) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(__NR_io_uring_register)
+#define SCL_IO_URING_AVAILABLE
+#endif
+
+namespace scl::extensions {
+
+    IoUringLogStrategy::IoUringLogStrategy(std::string file_path, std::shared_ptr<msg::LogLevelMsgFormat> log_format, size_t buffer_size, size_t buffer_count, scl::formatters_collection addition_formatters)
+        : _file_path(file_path), _buffer_size(buffer_size), _log_format(log_format) {
+        _formatters = addition_formatters;
+        _compiled_formats = utils::compile_log_level_format(*log_format, _formatters, addition_formatters.empty(), formatter::COLOR_MODE::STRIP);
+
+        //records are written at explicit offsets, the file must not be appended by anyone else
+        _fd = open(file_path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+
+        if (_fd < 0)
+            throw exceptions::log_file_unawalable_exception("Can't open required file", _file_path);
+
+        _file_offset = static_cast<std::uint64_t>(lseek(_fd, 0, SEEK_END));
+
+        _buffers.resize(std::max<size_t>(buffer_count, 2));
+
+        for (auto& buffer : _buffers)
+            buffer.data.reset(new char[_buffer_size]);
+
+        //a short write is resubmitted only after its completion, so one entry per buffer is enough
+        if (!setup_ring(static_cast<unsigned>(_buffers.size())))
+            release_ring();
+    }
+
+    IoUringLogStrategy::IoUringLogStrategy(json& cfg, scl::formatters_collection addition_formatters)
+        : IoUringLogStrategy(
+            cfg.contains("file_path") ? cfg["file_path"].get<std::string>() : "./default.log",
+            cfg.contains("log_format") ? std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{ cfg["log_format"] }) : std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}),
+            cfg.contains("buffer_size") ? cfg["buffer_size"].get<size_t>() : 256 * 1024,
+            cfg.contains("buffer_count") ? cfg["buffer_count"].get<size_t>() : 4,
+            addition_formatters
+        )
+    {
+        if (cfg.contains("min_level"))
+            set_min_level(msg::event_type_from_string(cfg["min_level"].get<std::string>()));
+    }
+
+    IoUringLogStrategy::~IoUringLogStrategy() {
+        flush();
+        release_ring();
+        close(_fd);
+    }
+
+    auto IoUringLogStrategy::setup_ring(unsigned entries) -> bool {
+#if defined(SCL_IO_URING_AVAILABLE)
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        _ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+
+        if (_ring_fd < 0)
+            return false;
+
+        _sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        _cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            _sq_ring_size = _cq_ring_size = std::max(_sq_ring_size, _cq_ring_size);
+
+        void* sq_ring = mmap(nullptr, _sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQ_RING);
+
+        if (sq_ring == MAP_FAILED)
+            return false;
+
+        _sq_ring = sq_ring;
+
+        if (params.features & IORING_FEAT_SINGLE_MMAP)
+            _cq_ring = _sq_ring;
+        else
+        {
+            void* cq_ring = mmap(nullptr, _cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_CQ_RING);
+
+            if (cq_ring == MAP_FAILED)
+                return false;
+
+            _cq_ring = cq_ring;
+        }
+
+        _sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = mmap(nullptr, _sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ring_fd, IORING_OFF_SQES);
+
+        if (sqes == MAP_FAILED)
+            return false;
+
+        _sqes = sqes;
+
+        char* sq = static_cast<char*>(_sq_ring);
+        char* cq = static_cast<char*>(_cq_ring);
+
+        _sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        _sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        _sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        _cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        _cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        _cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        _cqes = cq + params.cq_off.cqes;
+
+        std::vector<iovec> iovecs(_buffers.size());
+
+        for (size_t i = 0; i < _buffers.size(); i++)
+        {
+            iovecs[i].iov_base = _buffers[i].data.get();
+            iovecs[i].iov_len = _buffer_size;
+        }
+
+        //registration pins the pages, it fails when RLIMIT_MEMLOCK is too small
+        if (syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(), static_cast<unsigned>(iovecs.size())) != 0)
+            return false;
+
+        if (syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_FILES, &_fd, 1u) != 0)
+            return false;
+
+        return is_write_fixed_supported();
+#else
+        (void)entries;
+        return false;
+#endif // SCL_IO_URING_AVAILABLE
+    }
+
+    //probe appeared in 5.6 together with IOSQE_ASYNC, older kernels use the fallback
+    auto IoUringLogStrategy::is_write_fixed_supported() -> bool {
+#if defined(SCL_IO_URING_AVAILABLE) && defined(IO_URING_OP_SUPPORTED)
+        const unsigned ops_count = 256;
+        std::vector<char> probe_storage(sizeof(io_uring_probe) + ops_count * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(probe_storage.data());
+
+        if (syscall(__NR_io_uring_register, _ring_fd, IORING_REGISTER_PROBE, probe, ops_count) != 0)
+            return false;
+
+        return probe->last_op >= IORING_OP_WRITE_FIXED && (probe->ops[IORING_OP_WRITE_FIXED].flags & IO_URING_OP_SUPPORTED);
+#else
+        return false;
+#endif // IO_URING_OP_SUPPORTED
+    }
+
+    auto IoUringLogStrategy::release_ring() -> void {
+        if (_sqes)
+            munmap(_sqes, _sqes_size);
+
+        if (_cq_ring && _cq_ring != _sq_ring)
+            munmap(_cq_ring, _cq_ring_size);
+
+        if (_sq_ring)
+            munmap(_sq_ring, _sq_ring_size);
+
+        if (_ring_fd >= 0)
+            close(_ring_fd);
+
+        _sqes = _cq_ring = _sq_ring = nullptr;
+        _ring_fd = -1;
+        _ring_failed = false;
+    }
+
+    auto IoUringLogStrategy::submit_write(size_t index) -> void {
+        Buffer& buffer = _buffers[index];
+
+        if (!buffer.is_in_flight)
+        {
+            buffer.file_offset = _file_offset;
+            buffer.written = 0;
+            buffer.is_in_flight = true;
+            _file_offset += buffer.size;
+            _in_flight++;
+        }
+
+        if (_ring_fd >= 0 && !_ring_failed && submit_to_ring(index))
+            return;
+
+        while (buffer.written < buffer.size)
+        {
+            ssize_t written = pwrite(_fd, buffer.data.get() + buffer.written, buffer.size - buffer.written, static_cast<off_t>(buffer.file_offset + buffer.written));
+
+            if (written < 0 && errno == EINTR)
+                continue;
+
+            if (written <= 0)
+                break;
+
+            buffer.written += static_cast<size_t>(written);
+        }
+
+        buffer.size = 0;
+        buffer.is_in_flight = false;
+        _in_flight--;
+    }
+
+    //returns false if the entry wasn't consumed by the kernel, the entry is taken back then and the caller writes the buffer with pwrite
+    //EAGAIN and EBUSY are short of kernel resources or completion space and keep the ring, other errors switch to pwrite
+    auto IoUringLogStrategy::submit_to_ring(size_t index) -> bool {
+#if defined(SCL_IO_URING_AVAILABLE)
+        Buffer& buffer = _buffers[index];
+        unsigned tail = *_sq_tail;
+        unsigned sqe_index = tail & *_sq_mask;
+        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(_sqes)[sqe_index];
+
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = IORING_OP_WRITE_FIXED;
+        //without IOSQE_ASYNC a page cache write is done inline by io_uring_enter, i.e. on the logging thread
+        sqe.flags = IOSQE_FIXED_FILE | IOSQE_ASYNC;
+        sqe.fd = 0;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer.data.get() + buffer.written);
+        sqe.len = static_cast<std::uint32_t>(buffer.size - buffer.written);
+        sqe.off = buffer.file_offset + buffer.written;
+        sqe.buf_index = static_cast<std::uint16_t>(index);
+        sqe.user_data = index;
+
+        _sq_array[sqe_index] = sqe_index;
+        __atomic_store_n(_sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+        long submitted;
+
+        while ((submitted = syscall(__NR_io_uring_enter, _ring_fd, 1u, 0u, 0u, nullptr, 0)) < 0 && errno == EINTR)
+        {
+        }
+
+        if (submitted == 1)
+            return true;
+
+        if (submitted < 0 && errno != EAGAIN && errno != EBUSY)
+            _ring_failed = true;
+
+        __atomic_store_n(_sq_tail, tail, __ATOMIC_RELEASE);
+        return false;
+#else
+        (void)index;
+        return false;
+#endif // SCL_IO_URING_AVAILABLE
+    }
+
+    auto IoUringLogStrategy::reap(unsigned min_complete) -> void {
+#if defined(SCL_IO_URING_AVAILABLE)
+        if (_ring_fd < 0)
+            return;
+
+        unsigned head = *_cq_head;
+
+        if (min_complete > 0)
+        {
+            long entered;
+
+            while ((entered = syscall(__NR_io_uring_enter, _ring_fd, 0u, min_complete, static_cast<unsigned>(IORING_ENTER_GETEVENTS), nullptr, 0)) < 0 && errno == EINTR)
+            {
+            }
+
+            //completions can't be waited for, flush() would call reap forever
+            if (entered < 0 && head == __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE))
+            {
+                abandon_ring();
+                return;
+            }
+        }
+
+        while (head != __atomic_load_n(_cq_tail, __ATOMIC_ACQUIRE))
+        {
+            const io_uring_cqe& cqe = static_cast<const io_uring_cqe*>(_cqes)[head & *_cq_mask];
+            size_t index = static_cast<size_t>(cqe.user_data);
+            int result = cqe.res;
+
+            __atomic_store_n(_cq_head, ++head, __ATOMIC_RELEASE);
+
+            Buffer& buffer = _buffers[index];
+
+            if (result == -EINTR || result == -EAGAIN)
+            {
+                submit_write(index);
+                continue;
+            }
+
+            //on error the rest is written with pwrite and later buffers don't use the ring anymore
+            if (result <= 0)
+                _ring_failed = true;
+            else
+                buffer.written += static_cast<size_t>(result);
+
+            if (buffer.written < buffer.size)
+            {
+                submit_write(index);
+                continue;
+            }
+
+            buffer.size = 0;
+            buffer.is_in_flight = false;
+            _in_flight--;
+        }
+
+        //ring is released once no request refers to registered buffers
+        if (_ring_failed && _in_flight == 0)
+            release_ring();
+#else
+        (void)min_complete;
+#endif // SCL_IO_URING_AVAILABLE
+    }
+
+    //buffers in flight are written again with pwrite, a request still running in the kernel writes the same bytes at the same offsets
+    //their storage is kept until destruction and replaced, as the kernel may still read it
+    auto IoUringLogStrategy::abandon_ring() -> void {
+        _ring_failed = true;
+
+        for (size_t i = 0; i < _buffers.size(); i++)
+        {
+            Buffer& buffer = _buffers[i];
+
+            if (!buffer.is_in_flight)
+                continue;
+
+            submit_write(i);
+
+            _abandoned_data.push_back(std::move(buffer.data));
+            buffer.data.reset(new char[_buffer_size]);
+        }
+
+        release_ring();
+    }
+
+    auto IoUringLogStrategy::switch_buffer() -> void {
+        submit_write(_active);
+        reap(0);
+
+        while (true)
+        {
+            for (size_t i = 0; i < _buffers.size(); i++)
+            {
+                if (!_buffers[i].is_in_flight)
+                {
+                    _active = i;
+                    return;
+                }
+            }
+
+            reap(1);
+        }
+    }
+
+    auto IoUringLogStrategy::log(const msg::LogMsg& log_msg) -> void {
+        log_batch(&log_msg, 1);
+    }
+
+    auto IoUringLogStrategy::log_batch(const msg::LogMsg* log_msgs, size_t count) -> void {
+        _record.clear();
+
+        for (size_t i = 0; i < count; i++)
+            _compiled_formats[msg::LogLevelMsgFormat::format_index(log_msgs[i])].render(_record, log_msgs[i]);
+
+        const char* data = _record.data();
+        size_t size = _record.size();
+
+        while (size > 0)
+        {
+            Buffer& buffer = _buffers[_active];
+            size_t part = std::min(size, _buffer_size - buffer.size);
+
+            std::memcpy(buffer.data.get() + buffer.size, data, part);
+            buffer.size += part;
+            data += part;
+            size -= part;
+
+            if (buffer.size == _buffer_size)
+                switch_buffer();
+        }
+    }
+
+    auto IoUringLogStrategy::flush() -> void {
+        if (_buffers[_active].size > 0)
+            submit_write(_active);
+
+        while (_in_flight > 0)
+            reap(1);
+    }
+
+    auto IoUringLogStrategy::is_io_uring_active() const -> bool {
+        return _ring_fd >= 0 && !_ring_failed;
+    }
+}
+
+#endif // __linux__
@@ -0,0 +1,93 @@
+#ifndef io_uring_log_strategy
+#define io_uring_log_strategy
+
+#include "../include/SimpleCppLogger.hpp"
+#include <memory>
+
+#if defined(__linux__)
+
+namespace scl::extensions {
+
+	//file sink submitting filled buffers through io_uring, the logging thread only waits when every buffer is in flight
+	//buffers are registered with the ring and written at explicit offsets, so out of order completions keep record order
+	//if io_uring can't be set up (old kernel or headers, seccomp) buffers are written with pwrite
+	//a failed submission or write completion switches to pwrite as well, the failed buffer is finished with it
+	class IoUringLogStrategy : public scl::interface::ILogStrategy
+	{
+	private:
+		struct Buffer
+		{
+			std::unique_ptr<char[]> data;
+			size_t size = 0;
+			//bytes already written by completed part of a short write
+			size_t written = 0;
+			std::uint64_t file_offset = 0;
+			bool is_in_flight = false;
+		};
+
+		std::string _file_path;
+		int _fd = -1;
+		std::uint64_t _file_offset = 0;
+		const size_t _buffer_size;
+		std::vector<Buffer> _buffers;
+		//storage of buffers left in flight by abandon_ring
+		std::vector<std::unique_ptr<char[]>> _abandoned_data;
+		size_t _active = 0;
+		size_t _in_flight = 0;
+		std::shared_ptr<msg::LogLevelMsgFormat> _log_format;
+		scl::formatters_collection _formatters;
+		formatter::compiled_formats _compiled_formats;
+		std::string _record;
+
+		//ring state, _ring_fd < 0 when the pwrite fallback is used
+		int _ring_fd = -1;
+		//set by a failed submission or completion, the ring is released when requests in flight complete
+		bool _ring_failed = false;
+		void* _sq_ring = nullptr;
+		size_t _sq_ring_size = 0;
+		void* _cq_ring = nullptr;
+		size_t _cq_ring_size = 0;
+		void* _sqes = nullptr;
+		size_t _sqes_size = 0;
+		unsigned* _sq_tail = nullptr;
+		unsigned* _sq_mask = nullptr;
+		unsigned* _sq_array = nullptr;
+		unsigned* _cq_head = nullptr;
+		unsigned* _cq_tail = nullptr;
+		unsigned* _cq_mask = nullptr;
+		void* _cqes = nullptr;
+
+		auto setup_ring(unsigned entries) -> bool;
+		auto is_write_fixed_supported() -> bool;
+		auto release_ring() -> void;
+		auto submit_write(size_t index) -> void;
+		auto submit_to_ring(size_t index) -> bool;
+		//handles completions already posted, waits for at least min_complete of them
+		auto reap(unsigned min_complete) -> void;
+		//switches to pwrite when completions can't be waited for
+		auto abandon_ring() -> void;
+		//submits active buffer and makes a free one active
+		auto switch_buffer() -> void;
+
+	public:
+		IoUringLogStrategy(std::string file_path = "./default.log", std::shared_ptr<msg::LogLevelMsgFormat> log_format = std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}), size_t buffer_size = 256 * 1024, size_t buffer_count = 4, scl::formatters_collection addition_formatters = scl::formatters_collection{});
+		//fields: file_path, log_format, buffer_size, buffer_count, min_level
+		IoUringLogStrategy(json& cfg, scl::formatters_collection addition_formatters = scl::formatters_collection{});
+
+		~IoUringLogStrategy() override;
+
+		auto log(const msg::LogMsg& log_msg) -> void override;
+
+		auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void override;
+
+		//waits until every buffer is written
+		auto flush() -> void override;
+
+		auto is_io_uring_active() const -> bool;
+	};
+
+}
+
+#endif // __linux__
+
+#endif //io_uring_log_strategy
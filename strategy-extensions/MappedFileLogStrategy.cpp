@@ -0,0 +1,212 @@
+#include "MappedFileLogStrategy.hpp"
+
+#if defined(__linux__)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace scl::extensions {
+
+    //length of file without zero bytes preallocated after the last record
+    static auto written_length(int fd) -> off_t {
+        struct stat file_stat;
+
+        if (fstat(fd, &file_stat) != 0)
+            return 0;
+
+        char block[64 * 1024];
+        off_t end = file_stat.st_size;
+
+        while (end > 0)
+        {
+            off_t begin = std::max<off_t>(0, end - static_cast<off_t>(sizeof(block)));
+            ssize_t read_size = pread(fd, block, static_cast<size_t>(end - begin), begin);
+
+            if (read_size <= 0)
+                return end;
+
+            for (ssize_t i = read_size; i > 0; i--)
+                if (block[i - 1] != '\0')
+                    return begin + i;
+
+            end = begin;
+        }
+
+        return 0;
+    }
+
+    static auto msync_policy_from_string(const std::string& name) -> MSYNC_POLICY {
+        if (name == "none")
+            return MSYNC_POLICY::NONE;
+
+        if (name == "async")
+            return MSYNC_POLICY::ASYNC;
+
+        if (name == "sync")
+            return MSYNC_POLICY::SYNC;
+
+        throw exceptions::incorrect_config_format("Unknown msync policy: " + name);
+    }
+
+    MappedFileLogStrategy::MappedFileLogStrategy(std::string file_path, std::shared_ptr<msg::LogLevelMsgFormat> log_format, size_t chunk_size, MSYNC_POLICY msync_policy, scl::formatters_collection addition_formatters)
+        : _file_path(file_path), _msync_policy(msync_policy), _log_format(log_format) {
+        size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        _chunk_size = std::max<size_t>(page_size, (chunk_size + page_size - 1) / page_size * page_size);
+
+        _formatters = addition_formatters;
+        _compiled_formats = utils::compile_log_level_format(*log_format, _formatters, addition_formatters.empty(), formatter::COLOR_MODE::STRIP);
+
+        _fd = open(file_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+
+        if (_fd < 0)
+            throw exceptions::log_file_unawalable_exception("Can't open required file", _file_path);
+
+        //previous run may have crashed before truncating its last chunk
+        off_t length = written_length(_fd);
+
+        if (ftruncate(_fd, length) != 0 || !map_chunk(static_cast<size_t>(length) / page_size * page_size))
+        {
+            close(_fd);
+            throw exceptions::log_file_unawalable_exception("Can't map required file", _file_path);
+        }
+
+        _tail = static_cast<size_t>(length) - _chunk_offset;
+        _synced = _tail;
+    }
+
+    MappedFileLogStrategy::MappedFileLogStrategy(json& cfg, scl::formatters_collection addition_formatters)
+        : MappedFileLogStrategy(
+            cfg.contains("file_path") ? cfg["file_path"].get<std::string>() : "./default.log",
+            cfg.contains("log_format") ? std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{ cfg["log_format"] }) : std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}),
+            cfg.contains("chunk_size") ? cfg["chunk_size"].get<size_t>() : 64 * 1024 * 1024,
+            cfg.contains("msync") ? msync_policy_from_string(cfg["msync"].get<std::string>()) : MSYNC_POLICY::NONE,
+            addition_formatters
+        )
+    {
+        if (cfg.contains("min_level"))
+            set_min_level(msg::event_type_from_string(cfg["min_level"].get<std::string>()));
+    }
+
+    MappedFileLogStrategy::~MappedFileLogStrategy() {
+        if (_chunk)
+        {
+            sync_chunk();
+            munmap(_chunk, _chunk_size);
+        }
+
+        //if truncation fails the zero tail stays in the file and is cut off when the file is opened again
+        while (ftruncate(_fd, static_cast<off_t>(_chunk_offset + _tail)) != 0 && errno == EINTR) {}
+
+        close(_fd);
+    }
+
+    auto MappedFileLogStrategy::map_chunk(size_t offset) -> bool {
+        _chunk_offset = offset;
+        _tail = 0;
+        _synced = 0;
+
+        //fallocate is not supported by every file system, sparse extension is mapped the same way there
+        //any other error (no space, quota) means writes to a sparse mapping would raise SIGBUS
+        if (fallocate(_fd, 0, static_cast<off_t>(offset), static_cast<off_t>(_chunk_size)) != 0)
+        {
+            if (errno != EOPNOTSUPP && errno != ENOSYS)
+                return false;
+
+            if (ftruncate(_fd, static_cast<off_t>(offset + _chunk_size)) != 0)
+                return false;
+        }
+
+        void* chunk = mmap(nullptr, _chunk_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, static_cast<off_t>(offset));
+
+        if (chunk == MAP_FAILED)
+            return false;
+
+        _chunk = static_cast<char*>(chunk);
+        return true;
+    }
+
+    auto MappedFileLogStrategy::sync_chunk() -> void {
+        if (_msync_policy == MSYNC_POLICY::NONE || _synced == _tail)
+            return;
+
+        size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t begin = _synced / page_size * page_size;
+
+        msync(_chunk + begin, _tail - begin, _msync_policy == MSYNC_POLICY::SYNC ? MS_SYNC : MS_ASYNC);
+        _synced = _tail;
+    }
+
+    //used once a chunk can't be mapped, the rest of the file is written at the same offsets with pwrite
+    //on write error the rest of the data is dropped
+    auto MappedFileLogStrategy::write_tail(const char* data, size_t size) -> void {
+        while (size > 0)
+        {
+            ssize_t written = pwrite(_fd, data, size, static_cast<off_t>(_chunk_offset + _tail));
+
+            if (written < 0 && errno == EINTR)
+                continue;
+
+            if (written <= 0)
+                return;
+
+            _tail += static_cast<size_t>(written);
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    //records may span chunks, if next chunk can't be mapped the rest goes through write_tail
+    auto MappedFileLogStrategy::append(const char* data, size_t size) -> void {
+        while (size > 0)
+        {
+            if (!_chunk)
+            {
+                write_tail(data, size);
+                return;
+            }
+
+            size_t part = (std::min)(size, _chunk_size - _tail);
+
+            std::memcpy(_chunk + _tail, data, part);
+            _tail += part;
+            data += part;
+            size -= part;
+
+            if (_tail == _chunk_size)
+            {
+                sync_chunk();
+                munmap(_chunk, _chunk_size);
+                _chunk = nullptr;
+
+                map_chunk(_chunk_offset + _chunk_size);
+            }
+        }
+    }
+
+    auto MappedFileLogStrategy::log(const msg::LogMsg& log_msg) -> void {
+        log_batch(&log_msg, 1);
+    }
+
+    auto MappedFileLogStrategy::log_batch(const msg::LogMsg* log_msgs, size_t count) -> void {
+        _record.clear();
+
+        for (size_t i = 0; i < count; i++)
+            _compiled_formats[msg::LogLevelMsgFormat::format_index(log_msgs[i])].render(_record, log_msgs[i]);
+
+        append(_record.data(), _record.size());
+    }
+
+    auto MappedFileLogStrategy::flush() -> void {
+        if (_chunk)
+            sync_chunk();
+        else if (_msync_policy == MSYNC_POLICY::SYNC)
+            fdatasync(_fd);
+    }
+}
+
+#endif // __linux__
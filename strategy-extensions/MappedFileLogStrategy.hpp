@@ -0,0 +1,67 @@
+#ifndef mapped_file_log_strategy
+#define mapped_file_log_strategy
+
+#include "../include/SimpleCppLogger.hpp"
+#include <memory>
+
+#if defined(__linux__)
+
+namespace scl::extensions {
+
+	enum class MSYNC_POLICY
+	{
+		//written pages are left to the kernel, flush() does nothing
+		NONE,
+		//flush() and chunk switch schedule writeback of written pages
+		ASYNC,
+		//flush() and chunk switch return once written pages are on disk
+		SYNC,
+	};
+
+	//append-only file sink, the file is extended by chunk_size with fallocate and records are copied into the mapped chunk
+	//the file is truncated to the written length on close, trailing zero bytes left by a crash are cut off when the file is opened again
+	//if a chunk can't be mapped (no space for fallocate, mmap error) later records are written with pwrite
+	class MappedFileLogStrategy : public scl::interface::ILogStrategy
+	{
+	private:
+		std::string _file_path;
+		int _fd = -1;
+		size_t _chunk_size;
+		MSYNC_POLICY _msync_policy;
+		//current chunk, starts at _chunk_offset in the file
+		char* _chunk = nullptr;
+		size_t _chunk_offset = 0;
+		//bytes written to current chunk
+		size_t _tail = 0;
+		//bytes of current chunk passed to msync
+		size_t _synced = 0;
+		std::shared_ptr<msg::LogLevelMsgFormat> _log_format;
+		scl::formatters_collection _formatters;
+		formatter::compiled_formats _compiled_formats;
+		std::string _record;
+
+		auto map_chunk(size_t offset) -> bool;
+		auto sync_chunk() -> void;
+		auto write_tail(const char* data, size_t size) -> void;
+		auto append(const char* data, size_t size) -> void;
+
+	public:
+		//chunk_size is rounded up to page size
+		MappedFileLogStrategy(std::string file_path = "./default.log", std::shared_ptr<msg::LogLevelMsgFormat> log_format = std::shared_ptr<msg::LogLevelMsgFormat>(new msg::LogLevelMsgFormat{}), size_t chunk_size = 64 * 1024 * 1024, MSYNC_POLICY msync_policy = MSYNC_POLICY::NONE, scl::formatters_collection addition_formatters = scl::formatters_collection{});
+		//fields: file_path, log_format, chunk_size, msync (none/async/sync), min_level
+		MappedFileLogStrategy(json& cfg, scl::formatters_collection addition_formatters = scl::formatters_collection{});
+
+		~MappedFileLogStrategy() override;
+
+		auto log(const msg::LogMsg& log_msg) -> void override;
+
+		auto log_batch(const msg::LogMsg* log_msgs, size_t count) -> void override;
+
+		auto flush() -> void override;
+	};
+
+}
+
+#endif // __linux__
+
+#endif //mapped_file_log_strategy
@@ -0,0 +1,157 @@
+#include "../include/SimpleCppLogger.hpp"
+#include "../strategy-extensions/CompressedFileLogStrategy.hpp"
+#include <filesystem>
+#include <random>
+#include <sstream>
+
+namespace {
+
+	int failures = 0;
+
+	auto check(bool condition, const char* description) -> void {
+		if (condition)
+			return;
+
+		std::printf("FAILED: %s\n", description);
+		failures++;
+	}
+
+	auto make_format() -> std::shared_ptr<scl::msg::LogLevelMsgFormat> {
+		scl::msg::MsgFormat format{ "{msg}{nl}", "{msg}{nl}" };
+		return std::make_shared<scl::msg::LogLevelMsgFormat>(format, format, format, format, format);
+	}
+
+	//raw text of every block written so far, one flush makes one block
+	std::vector<std::string> blocks;
+	std::mt19937 random{ 42 };
+
+	auto write_blocks(const std::string& file_path, size_t count) -> void {
+		scl::extensions::CompressedFileLogStrategy strategy(file_path, make_format(), 64 * 1024);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			std::string block;
+			size_t number = blocks.size();
+
+			for (size_t line = 0; line < 3; line++)
+			{
+				std::string text = "block " + std::to_string(number) + " line " + std::to_string(line) + " repeated payload repeated payload";
+
+				//random text doesn't shrink, such blocks are stored uncompressed
+				if (number % 100 == 0)
+					for (size_t c = 0; c < 40; c++)
+						text.push_back(static_cast<char>('!' + random() % 90));
+
+				strategy.log(scl::msg::LogMsg{ text, scl::msg::EVENT_TYPE::LOG_INFO, false, 0 });
+				block += text + "\n";
+			}
+
+			strategy.flush();
+			blocks.push_back(block);
+		}
+	}
+
+	auto joined(size_t count) -> std::string {
+		std::string text;
+
+		for (size_t i = 0; i < count; i++)
+			text += blocks[i];
+
+		return text;
+	}
+
+	auto decompress(const std::string& file_path, std::string& text) -> scl::extensions::DECOMPRESS_RESULT {
+		std::ifstream in(file_path, std::ios::binary);
+		std::ostringstream out;
+		auto result = scl::extensions::decompress_log(in, out);
+		text = out.str();
+		return result;
+	}
+
+	//offsets of block headers, stored size is at offset 12 of a header
+	auto block_offsets(const std::string& file_path) -> std::vector<std::uintmax_t> {
+		std::ifstream in(file_path, std::ios::binary);
+		std::uintmax_t file_size = std::filesystem::file_size(file_path);
+		std::vector<std::uintmax_t> offsets;
+		std::uintmax_t offset = 0;
+		unsigned char header[scl::extensions::CompressedBlockHeader::size];
+
+		while (offset + sizeof(header) <= file_size)
+		{
+			in.seekg(static_cast<std::streamoff>(offset));
+			in.read(reinterpret_cast<char*>(header), sizeof(header));
+
+			std::uint32_t stored_size = header[12] | (header[13] << 8) | (header[14] << 16) | (static_cast<std::uint32_t>(header[15]) << 24);
+			offsets.push_back(offset);
+			offset += sizeof(header) + stored_size;
+		}
+
+		return offsets;
+	}
+
+	auto overwrite(const std::string& file_path, std::uintmax_t offset, const std::string& data) -> void {
+		std::fstream file(file_path, std::ios::binary | std::ios::in | std::ios::out);
+		file.seekp(static_cast<std::streamoff>(offset));
+		file.write(data.data(), static_cast<std::streamsize>(data.size()));
+	}
+}
+
+//round trip of 3000 blocks, then a torn tail is cut off on reopen and damage in the middle is left as is
+//exit code 1 if any check fails
+int main() {
+	using scl::extensions::DECOMPRESS_RESULT;
+
+	std::filesystem::path directory = std::filesystem::temp_directory_path() / "scl-test-compressed";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	std::string file_path = (directory / "app.log.sclz").string();
+	std::string text;
+
+	write_blocks(file_path, 3000);
+	check(block_offsets(file_path).size() == 3000, "one block per flush");
+	check(decompress(file_path, text) == DECOMPRESS_RESULT::COMPLETE && text == joined(3000), "round trip of 3000 blocks");
+
+	//crash in the middle of the last block
+	std::uintmax_t last_block = block_offsets(file_path).back();
+	std::filesystem::resize_file(file_path, last_block + 30);
+	check(decompress(file_path, text) == DECOMPRESS_RESULT::TRUNCATED && text == joined(2999), "partial block is reported as truncated");
+
+	blocks.pop_back();
+	write_blocks(file_path, 10);
+	check(decompress(file_path, text) == DECOMPRESS_RESULT::COMPLETE && text == joined(blocks.size()), "partial block is cut off on reopen");
+
+	//file system extended the file with zeros
+	std::uintmax_t file_size = std::filesystem::file_size(file_path);
+	std::filesystem::resize_file(file_path, file_size + 8192);
+	write_blocks(file_path, 1);
+	check(decompress(file_path, text) == DECOMPRESS_RESULT::COMPLETE && text == joined(blocks.size()), "zero tail is cut off on reopen");
+
+	//file system kept the size of the last block without its data
+	last_block = block_offsets(file_path).back();
+	file_size = std::filesystem::file_size(file_path);
+	overwrite(file_path, last_block + scl::extensions::CompressedBlockHeader::size, std::string(static_cast<size_t>(file_size - last_block - scl::extensions::CompressedBlockHeader::size), '\0'));
+	blocks.pop_back();
+	write_blocks(file_path, 1);
+	check(decompress(file_path, text) == DECOMPRESS_RESULT::COMPLETE && text == joined(blocks.size()), "last block with bad checksum is cut off on reopen");
+
+	//damage followed by valid blocks is not a torn tail
+	std::uintmax_t damaged_block = block_offsets(file_path)[1500];
+	overwrite(file_path, damaged_block + scl::extensions::CompressedBlockHeader::size + 2, "\x7f\x7f");
+	file_size = std::filesystem::file_size(file_path);
+	check(decompress(file_path, text) == DECOMPRESS_RESULT::DAMAGED && text == joined(1500), "damaged block stops decompression");
+
+	write_blocks(file_path, 0);
+	check(std::filesystem::file_size(file_path) == file_size, "damage in the middle is not cut off on reopen");
+
+	//damaged header in the middle
+	overwrite(file_path, damaged_block, "XXXX");
+	write_blocks(file_path, 0);
+	check(std::filesystem::file_size(file_path) == file_size, "damaged header in the middle is not cut off on reopen");
+
+	std::filesystem::remove_all(directory);
+
+	if (failures == 0)
+		std::printf("all checks passed\n");
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+#include "../../strategy-extensions/CompressedFileLogStrategy.hpp"
+#include <fstream>
+#include <iostream>
+
+//restores text log written by CompressedFileLogStrategy
+//exit code: 0 - whole file restored, 1 - bad arguments or file, 2 - file ends inside a block, 3 - damaged block
+int main(int argc, char** argv) {
+	if (argc < 2 || argc > 3)
+	{
+		std::cerr << "usage: scl-decompress <compressed log> [output file]" << std::endl;
+		return 1;
+	}
+
+	std::ifstream in(argv[1], std::ios::binary);
+
+	if (!in.is_open())
+	{
+		std::cerr << "can't open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::ofstream out_file;
+
+	if (argc == 3)
+	{
+		out_file.open(argv[2], std::ios::binary | std::ios::trunc);
+
+		if (!out_file.is_open())
+		{
+			std::cerr << "can't open " << argv[2] << std::endl;
+			return 1;
+		}
+	}
+
+	std::ostream& out = argc == 3 ? out_file : std::cout;
+
+	switch (scl::extensions::decompress_log(in, out))
+	{
+	case scl::extensions::DECOMPRESS_RESULT::TRUNCATED:
+		std::cerr << "file ends inside a block, restored up to the last complete block" << std::endl;
+		return 2;
+	case scl::extensions::DECOMPRESS_RESULT::DAMAGED:
+		std::cerr << "damaged block, restored up to the last valid block" << std::endl;
+		return 3;
+	default:
+		return 0;
+	}
+}